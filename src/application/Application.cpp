@@ -12,10 +12,16 @@
 #include <engine/ecs/components/RigidBody.hpp>
 #include <engine/ecs/components/Thrust.hpp>
 #include <engine/ecs/components/Transform.hpp>
+#include <engine/ecs/components/WorldTransform.hpp>
 #include <engine/ecs/components/Model.hpp>
+#include <engine/ecs/components/Parent.hpp>
 #include <engine/ecs/components/PointLight.hpp>
 #include <engine/ecs/components/DirectionalLight.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
 #include <fstream>
 #include <nlohmann/json.hpp>
 
@@ -89,6 +95,8 @@ void Application::init_lights() {
     //             .scale = glm::vec3(5.0f)
     //         },
 
+    //         Components::WorldTransform{},
+
     //         Components::PointLight {
     //             .light_color = glm::vec3(1.0f)
     //         }
@@ -108,7 +116,8 @@ void Application::init_lights() {
                 // .position = {1000.0f, 1000.0f, 0.0f}
                 .position = glm::vec3(10.0f, 50.0f, 10.0f),
                 .scale = glm::vec3(5.0f) // draw as big cube
-            }
+            },
+            Components::WorldTransform{}
         );
     }
 }
@@ -122,6 +131,7 @@ void Application::init_models() {
                 .position = glm::vec3(0.0f),
                 .scale = glm::vec3(0.2f)
             },
+            Components::WorldTransform{},
             Components::Renderable{},
             Components::Model{.model_id = v }
         );
@@ -148,14 +158,37 @@ void Application::run() {
             if(m_gui_state->dir_light0_direction[2] >= 1.0 || m_gui_state->dir_light0_direction[2] <= -1.0)
                 inc = !inc;
         }
-            
+
+        // the camera moves once per frame, between simulations, so that it is not interpolated between ticks.
+        // the input events are dispatched for it, even in frames without ticks
+        m_main_scene.dispatch_queued_events();
         m_camera_control_system->update(dt);
-        m_render_system->update(dt);
 
-        m_gui_main->new_frame();
-        m_gui_main->update();
-        m_gui_main->render();
-        m_gui_main->update_platform_windows();
+        if(m_pipelined_frames) {
+            // render the last simulated frame while the next one is simulated on the thread pool
+            m_render_system->extract_render_state(m_interpolation);
+            m_gui_state->scene_stats = m_main_scene.get_stats(); // read before the next frame changes the scene
+            m_main_scene.reset_churn(); // churn of all ticks of a frame
+
+            unsigned int ticks = advance_simulation_time(dt);
+
+            std::atomic<std::size_t> simulating = 1;
+            ThreadPool& thread_pool = m_main_scene.get_thread_pool();
+            thread_pool.submit([this, ticks] { simulate(ticks); }, simulating);
+
+            m_render_system->render();
+            update_gui();
+
+            thread_pool.wait(simulating); // the window update reads input which the systems also read
+        } else {
+            simulate(advance_simulation_time(dt)); // update all systems
+            m_gui_state->scene_stats = m_main_scene.get_stats();
+            m_main_scene.reset_churn();
+
+            m_render_system->extract_render_state(m_interpolation);
+            m_render_system->render();
+            update_gui();
+        }
 
         m_window_manager->update(); // window updation happens after windows have been processed
 
@@ -163,6 +196,51 @@ void Application::run() {
     }
 }
 
+void Application::set_tick_rate(float tick_rate) {
+    assert(tick_rate > 0.0f && "Tick rate must be positive");
+
+    m_tick_rate = tick_rate;
+}
+
+void Application::set_max_ticks_per_frame(unsigned int max_ticks) {
+    assert(max_ticks > 0 && "At least one tick per frame is needed");
+
+    m_max_ticks_per_frame = max_ticks;
+}
+
+unsigned int Application::advance_simulation_time(float dt) {
+    float tick = 1.0f / m_tick_rate;
+    m_accumulated_time += dt;
+
+    unsigned int ticks = static_cast<unsigned int>(m_accumulated_time / tick);
+
+    // the simulation can not keep up. drop the time it is behind instead of simulating more of it
+    // every frame, and keep the fraction of a tick so that interpolation stays smooth
+    if(ticks > m_max_ticks_per_frame) {
+        ticks = m_max_ticks_per_frame;
+        m_accumulated_time = ticks * tick + std::fmod(m_accumulated_time, tick);
+    }
+
+    m_accumulated_time = std::max(m_accumulated_time - ticks * tick, 0.0f);
+    m_interpolation = std::min(m_accumulated_time / tick, 1.0f);
+
+    return ticks;
+}
+
+void Application::simulate(unsigned int ticks) {
+    float tick = 1.0f / m_tick_rate;
+
+    for(unsigned int i = 0; i < ticks; i++)
+        m_main_scene.update(tick);
+}
+
+void Application::update_gui() {
+    m_gui_main->new_frame();
+    m_gui_main->update();
+    m_gui_main->render();
+    m_gui_main->update_platform_windows();
+}
+
 void Application::register_callbacks() {
     m_main_scene.add_event_listener(METHOD_LISTENER(Events::Window::QUIT, Application::quit_handler));
     
@@ -185,7 +263,8 @@ void Application::init_camera(int width, int height) {
 
 void Application::register_ecs_systems() {
     m_physics_system = &m_main_scene.register_system<PhysicsSystem>();
-    m_camera_control_system = &m_main_scene.register_system<CameraControlSystem>(*m_input_handler);
+    m_camera_control_system = std::make_unique<CameraControlSystem>(m_main_scene, *m_input_handler);
+    m_transform_system = &m_main_scene.register_system<TransformSystem>(); // before rendering systems
  
     // set render system
     int win_framebuffer_width, win_framebuffer_height;
@@ -205,10 +284,12 @@ void Application::register_ecs_components() {
         Components::Renderable,
         Components::RigidBody,
         Components::Transform,
+        Components::WorldTransform,
         Components::Model,
         Components::Cubemap,
         Components::PointLight,
         Components::DirectionalLight,
+        Components::Parent,
         
         Components::Player,
         Components::Thrust
@@ -6,6 +6,9 @@
 #include <engine/ecs/systems/PhysicsSystem.hpp>
 #include <engine/ecs/systems/PlayerControlSystem.hpp>
 #include <engine/ecs/systems/RenderSystem.hpp>
+#include <engine/ecs/systems/TransformSystem.hpp>
+
+#include <engine/config/SimulationConfig.hpp>
 
 #include <memory>
 // Application::init()
@@ -30,13 +33,22 @@ public:
     void update();
     
     void run(); // runs till window is not closed
+
+    // fixed simulation rate, in ticks per second. called between frames
+    void set_tick_rate(float tick_rate);
+    void set_max_ticks_per_frame(unsigned int max_ticks);
 private:
     void register_callbacks();
     void register_ecs_components();
     void init_camera(int width, int height);
     void register_ecs_systems(); // automatically creates main camera entity
+    void update_gui();
 
     void update_frame_times(float new_time, float& curr_time, float& last_time, float& dt);
+
+    // add the frame time to the simulation time, returns the number of ticks to simulate
+    unsigned int advance_simulation_time(float dt);
+    void simulate(unsigned int ticks);
     void quit_handler(Event& event);
 private:
     Scene m_main_scene;
@@ -45,9 +57,10 @@ private:
     std::unique_ptr<GUIMain> m_gui_main;
     std::unique_ptr<GUIState> m_gui_state;
 
-    // Scene owns the systems
+    // Scene owns the systems, except for the camera control which runs once per frame
     PhysicsSystem* m_physics_system;
-    CameraControlSystem* m_camera_control_system;
+    std::unique_ptr<CameraControlSystem> m_camera_control_system;
+    TransformSystem* m_transform_system;
     RenderSystem* m_render_system;
 
     models_interface_type m_models_map;
@@ -56,4 +69,14 @@ private:
 
     const char* m_glsl_version = "#version 130";
     bool m_quit = false;
+
+    // simulate frame N+1 on the thread pool while frame N is rendered. the rendered frame lags the simulation by one frame
+    bool m_pipelined_frames = true;
+
+    // fixed timestep: the scene is updated in ticks of 1 / m_tick_rate seconds, as many as fit in the
+    // simulation time, and rendered `m_interpolation` of a tick past the last tick
+    float m_tick_rate = SimulationConfig::DEFAULT_TICK_RATE;
+    unsigned int m_max_ticks_per_frame = SimulationConfig::DEFAULT_MAX_TICKS_PER_FRAME;
+    float m_accumulated_time = 0.0f; // simulation time not simulated yet, less than a tick
+    float m_interpolation = 1.0f;
 };
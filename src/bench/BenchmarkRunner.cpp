@@ -0,0 +1,170 @@
+#include <bench/BenchmarkRunner.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+BenchmarkResult BenchmarkContext::get_result(const std::string& name, std::uint32_t entities) const {
+    std::vector<double> samples = m_samples;
+    std::sort(samples.begin(), samples.end());
+
+    return BenchmarkResult {
+        .name = name,
+        .entities = entities,
+        .ns_per_op = samples[samples.size() / 2],
+        .min_ns_per_op = samples.front(),
+        .repetitions = samples.size()
+    };
+}
+
+void BenchmarkRunner::add(std::string name, benchmark_function_type benchmark) {
+    m_benchmarks.push_back({std::move(name), std::move(benchmark)});
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(const std::vector<std::uint32_t>& entity_counts, const std::string& filter,
+    std::chrono::duration<double> min_time) const {
+    std::vector<BenchmarkResult> results;
+
+    for(const Benchmark& benchmark : m_benchmarks) {
+        if(benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        for(std::uint32_t entities : entity_counts) {
+            BenchmarkContext context {min_time};
+            benchmark.function(context, entities);
+
+            if(!context.measured())
+                continue;
+
+            results.push_back(context.get_result(benchmark.name, entities));
+            print_results({results.back()});
+        }
+    }
+
+    return results;
+}
+
+void BenchmarkRunner::print_results(const std::vector<BenchmarkResult>& results) {
+    for(const BenchmarkResult& result : results) {
+        std::cout << std::left << std::setw(32) << result.name << std::right << std::setw(10) << result.entities
+                  << std::fixed << std::setprecision(3) << std::setw(14) << result.ns_per_op << " ns/op"
+                  << std::setw(14) << result.min_ns_per_op << " min" << std::setw(8) << result.repetitions << " reps\n";
+    }
+
+    std::cout << std::flush;
+}
+
+bool BenchmarkRunner::write_json(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream file {path};
+
+    if(!file)
+        return false;
+
+    // one result per line, so that `read_json` needs no JSON library
+    file << "{\n    \"benchmarks\": [\n";
+
+    for(std::size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+
+        file << "        {\"name\": \"" << result.name << "\", \"entities\": " << result.entities
+             << ", \"ns_per_op\": " << std::setprecision(9) << result.ns_per_op
+             << ", \"min_ns_per_op\": " << result.min_ns_per_op
+             << ", \"repetitions\": " << result.repetitions << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    file << "    ]\n}\n";
+
+    return bool(file);
+}
+
+static bool read_json_field(const std::string& line, const std::string& key, std::string& value) {
+    std::string quoted_key = "\"" + key + "\":";
+    std::size_t begin = line.find(quoted_key);
+
+    if(begin == std::string::npos)
+        return false;
+
+    begin = line.find_first_not_of(' ', begin + quoted_key.size());
+
+    if(begin == std::string::npos)
+        return false;
+
+    if(line[begin] == '"') {
+        std::size_t end = line.find('"', begin + 1);
+        value = line.substr(begin + 1, end - begin - 1);
+    } else {
+        std::size_t end = line.find_first_of(",}", begin);
+        value = line.substr(begin, end - begin);
+    }
+
+    return true;
+}
+
+bool BenchmarkRunner::read_json(const std::string& path, std::vector<BenchmarkResult>& results) {
+    std::ifstream file {path};
+
+    if(!file)
+        return false;
+
+    std::string line;
+
+    while(std::getline(file, line)) {
+        std::string name, entities, ns_per_op, min_ns_per_op, repetitions;
+
+        if(!read_json_field(line, "name", name))
+            continue;
+
+        if(!read_json_field(line, "entities", entities) || !read_json_field(line, "ns_per_op", ns_per_op)
+            || !read_json_field(line, "min_ns_per_op", min_ns_per_op) || !read_json_field(line, "repetitions", repetitions))
+            return false;
+
+        results.push_back(BenchmarkResult {
+            .name = name,
+            .entities = std::uint32_t(std::stoul(entities)),
+            .ns_per_op = std::stod(ns_per_op),
+            .min_ns_per_op = std::stod(min_ns_per_op),
+            .repetitions = std::stoull(repetitions)
+        });
+    }
+
+    return true;
+}
+
+std::size_t BenchmarkRunner::compare(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& results, double threshold) {
+    std::size_t regressions = 0;
+
+    std::cout << "\n" << std::left << std::setw(32) << "benchmark" << std::right << std::setw(10) << "entities"
+              << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(10) << "change" << "\n";
+
+    for(const BenchmarkResult& result : results) {
+        auto it = std::find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& base) {
+            return base.name == result.name && base.entities == result.entities;
+        });
+
+        std::cout << std::left << std::setw(32) << result.name << std::right << std::setw(10) << result.entities;
+
+        if(it == baseline.end()) {
+            std::cout << std::setw(14) << "-" << std::fixed << std::setprecision(3) << std::setw(14) << result.ns_per_op << "   (new)\n";
+            continue;
+        }
+
+        double change = result.ns_per_op / it->ns_per_op - 1.0;
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(14) << it->ns_per_op << std::setw(14) << result.ns_per_op
+                  << std::showpos << std::setprecision(1) << std::setw(9) << change * 100.0 << "%" << std::noshowpos;
+
+        if(change > threshold) {
+            std::cout << "   REGRESSION";
+            regressions++;
+        } else if(change < -threshold) {
+            std::cout << "   improved";
+        }
+
+        std::cout << "\n";
+    }
+
+    std::cout << std::flush;
+
+    return regressions;
+}
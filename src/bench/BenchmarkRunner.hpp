@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// BenchmarkRunner
+// Runs registered benchmarks at several entity counts and reports the time per operation.
+// A benchmark sets up its scene for the given entity count, then times a repeatable
+// operation with `BenchmarkContext::measure`:
+//      runner.add("view/2", [](BenchmarkContext& context, std::uint32_t entities) {
+//          Scene scene; ...
+//          context.measure(entities, [&] { SceneView<A, B>(scene).each(...); });
+//      });
+// The operation must leave the scene as it found it, since it is repeated.
+
+struct BenchmarkResult {
+    std::string name;
+    std::uint32_t entities;
+    double ns_per_op;       // median over the repetitions
+    double min_ns_per_op;
+    std::uint64_t repetitions;
+};
+
+class BenchmarkContext {
+public:
+    BenchmarkContext(std::chrono::duration<double> min_time): m_min_time{min_time} {}
+
+    // repeat `func` for at least the minimum time and record the time of each of its `operations`
+    template<typename Func>
+    void measure(std::uint64_t operations, Func&& func);
+
+    bool measured() const { return !m_samples.empty(); }
+    BenchmarkResult get_result(const std::string& name, std::uint32_t entities) const;
+
+private:
+    static constexpr std::uint64_t MIN_REPETITIONS = 3;
+    static constexpr std::uint64_t MAX_REPETITIONS = 1000;
+
+    std::chrono::duration<double> m_min_time;
+    std::vector<double> m_samples; // ns per operation of each repetition
+};
+
+class BenchmarkRunner {
+public:
+    using benchmark_function_type = std::function<void(BenchmarkContext& context, std::uint32_t entities)>;
+
+    void add(std::string name, benchmark_function_type benchmark);
+
+    // run the benchmarks whose name contains `filter` at every entity count
+    std::vector<BenchmarkResult> run(const std::vector<std::uint32_t>& entity_counts, const std::string& filter,
+        std::chrono::duration<double> min_time) const;
+
+    static void print_results(const std::vector<BenchmarkResult>& results);
+
+    static bool write_json(const std::string& path, const std::vector<BenchmarkResult>& results);
+    // reads the results written by `write_json`
+    static bool read_json(const std::string& path, std::vector<BenchmarkResult>& results);
+
+    // print the change of every result against the baseline result of the same name and entity count.
+    // returns the number of results slower than the baseline by more than `threshold` (0.1 = 10%)
+    static std::size_t compare(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& results, double threshold);
+
+private:
+    struct Benchmark {
+        std::string name;
+        benchmark_function_type function;
+    };
+
+    std::vector<Benchmark> m_benchmarks;
+};
+
+// keep the compiler from optimizing away a computed value
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T sink;
+    sink = value;
+#endif
+}
+
+template<typename Func>
+void BenchmarkContext::measure(std::uint64_t operations, Func&& func) {
+    using clock = std::chrono::steady_clock;
+
+    m_samples.clear();
+    func(); // warm up
+
+    std::chrono::duration<double> total {0};
+
+    while(m_samples.size() < MAX_REPETITIONS && (m_samples.size() < MIN_REPETITIONS || total < m_min_time)) {
+        auto start = clock::now();
+        func();
+        std::chrono::duration<double> elapsed = clock::now() - start;
+
+        total += elapsed;
+        m_samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / double(operations));
+    }
+}
@@ -0,0 +1,322 @@
+#include <bench/EcsBenchmarks.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneView.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+// components of the size of typical small components (a vec4)
+template<int N>
+struct Data {
+    float x = 1.0f, y = 2.0f, z = 3.0f, w = 4.0f;
+};
+
+using A = Data<0>;
+using B = Data<1>;
+using C = Data<2>;
+using D = Data<3>;
+using E = Data<4>;
+
+struct Excluded {};
+struct Tagged {};
+
+// a larger component of which the benchmarks only read the position, stored whole or split (see SplitComponent.hpp)
+struct Body {
+    Data<0> position;
+    Data<1> velocity;
+    Data<2> extents;
+};
+
+struct SplitBody {
+    Data<0> position;
+    Data<1> velocity;
+    Data<2> extents;
+};
+
+}
+
+template<>
+struct component_fields<SplitBody> {
+    using type = ComponentFields<&SplitBody::position, &SplitBody::velocity, &SplitBody::extents>;
+};
+
+namespace {
+
+struct BenchEvent {
+    int value;
+};
+
+constexpr EventId BENCH_EVENT_ID = 0x7e57u;
+
+std::vector<Entity> create_entities(Scene& scene, std::uint32_t count) {
+    std::vector<Entity> entities(count);
+
+    for(Entity& entity : entities)
+        entity = scene.create_entity();
+
+    return entities;
+}
+
+// scene of `count` entities with all of A to E
+void populate(Scene& scene, std::uint32_t count) {
+    scene.register_component<A, B, C, D, E, Excluded, Tagged>();
+
+    for(Entity entity : create_entities(scene, count))
+        scene.add_components(entity, A{}, B{}, C{}, D{}, E{});
+}
+
+template<typename ...ComponentTypes>
+void add_view_benchmark(BenchmarkRunner& runner, std::string name) {
+    runner.add(std::move(name), [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        populate(scene, entities);
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            SceneView<const ComponentTypes...>(scene).each([&](Entity entity, const ComponentTypes& ...components) {
+                sum += (components.x + ...);
+            });
+
+            do_not_optimize(sum);
+        });
+    });
+}
+
+}
+
+void register_ecs_benchmarks(BenchmarkRunner& runner) {
+    // entities
+    runner.add("entity/create_destroy", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        std::vector<Entity> created(entities);
+
+        context.measure(2ull * entities, [&] {
+            for(Entity& entity : created)
+                entity = scene.create_entity();
+
+            for(Entity entity : created)
+                scene.destroy_entity(entity);
+        });
+    });
+
+    runner.add("entity/destroy_with_components", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        scene.register_component<A, B, C, D, E, Excluded>();
+        std::vector<Entity> created(entities);
+
+        context.measure(entities, [&] {
+            for(Entity& entity : created) {
+                entity = scene.create_entity();
+                scene.add_components(entity, A{}, B{}, C{});
+            }
+
+            for(Entity entity : created)
+                scene.destroy_entity(entity);
+        });
+    });
+
+    // components
+    runner.add("component/add_remove", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        populate(scene, entities);
+        std::vector<Entity> created;
+
+        for(Entity entity : SceneView<A>(scene))
+            created.push_back(entity);
+
+        context.measure(2ull * entities, [&] {
+            for(Entity entity : created)
+                scene.add_component(entity, Excluded{});
+
+            for(Entity entity : created)
+                scene.remove_component<Excluded>(entity);
+        });
+    });
+
+    runner.add("component/get_random", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        populate(scene, entities);
+
+        std::vector<Entity> shuffled;
+        for(Entity entity : SceneView<A>(scene))
+            shuffled.push_back(entity);
+
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937{42});
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            for(Entity entity : shuffled)
+                sum += scene.get_component<C>(entity).x;
+
+            do_not_optimize(sum);
+        });
+    });
+
+    // views
+    add_view_benchmark<A>(runner, "view/1");
+    add_view_benchmark<A, B>(runner, "view/2");
+    add_view_benchmark<A, B, C>(runner, "view/3");
+    add_view_benchmark<A, B, C, D>(runner, "view/4");
+    add_view_benchmark<A, B, C, D, E>(runner, "view/5");
+
+    runner.add("view/2_exclude", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        populate(scene, entities);
+
+        // every other entity is excluded
+        std::uint32_t i = 0;
+        for(Entity entity : SceneView<A>(scene))
+            if(i++ % 2 == 0)
+                scene.add_component(entity, Excluded{});
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            SceneView<const A, const B>(scene, SceneViewExclude<Excluded>{}).each([&](Entity entity, const A& a, const B& b) {
+                sum += a.x + b.x;
+            });
+
+            do_not_optimize(sum);
+        });
+    });
+
+    runner.add("view/2_tag", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        populate(scene, entities);
+
+        // every other entity is tagged
+        std::uint32_t i = 0;
+        for(Entity entity : SceneView<A>(scene))
+            if(i++ % 2 == 0)
+                scene.add_component(entity, Tagged{});
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            SceneView<const A, const B, const Tagged>(scene).each([&](Entity entity, const A& a, const B& b, const Tagged&) {
+                sum += a.x + b.x;
+            });
+
+            do_not_optimize(sum);
+        });
+    });
+
+    // one field of a larger component
+    runner.add("field/whole", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        scene.register_component<Body>();
+
+        for(Entity entity : create_entities(scene, entities))
+            scene.add_component(entity, Body{});
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            SceneView<const Body>(scene).each([&](Entity entity, const Body& body) {
+                sum += body.position.x;
+            });
+
+            do_not_optimize(sum);
+        });
+    });
+
+    runner.add("field/split", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        scene.register_component<SplitBody>();
+
+        for(Entity entity : create_entities(scene, entities))
+            scene.add_component(entity, SplitBody{});
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            SceneView<const SplitBody>(scene).each([&](Entity entity, component_reference_t<const SplitBody> body) {
+                sum += body.get<&SplitBody::position>().x;
+            });
+
+            do_not_optimize(sum);
+        });
+    });
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    runner.add("field/split_span", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        scene.register_component<SplitBody>();
+
+        for(Entity entity : create_entities(scene, entities))
+            scene.add_component(entity, SplitBody{});
+
+        context.measure(entities, [&] {
+            float sum = 0.0f;
+
+            for(const Data<0>& position : scene.get_component_array<SplitBody>()->get_field<&SplitBody::position>())
+                sum += position.x;
+
+            do_not_optimize(sum);
+        });
+    });
+#endif
+
+    runner.add("view/2_write", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+        populate(scene, entities);
+
+        context.measure(entities, [&] {
+            SceneView<A, const B>(scene).each([](Entity entity, A& a, const B& b) {
+                a.x += b.x * 0.5f;
+            });
+        });
+    });
+
+    // events
+    runner.add("event/send_typed", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+
+        static int received = 0;
+        scene.add_event_listener(+[](const BenchEvent& event) { received += event.value; });
+
+        context.measure(entities, [&] {
+            for(std::uint32_t i = 0; i < entities; i++)
+                scene.send_event(BenchEvent{1});
+
+            do_not_optimize(received);
+        });
+    });
+
+    runner.add("event/queue_dispatch", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+
+        static int received = 0;
+        scene.add_event_listener(+[](const BenchEvent& event) { received += event.value; });
+
+        context.measure(entities, [&] {
+            for(std::uint32_t i = 0; i < entities; i++)
+                scene.queue_event(BenchEvent{1});
+
+            scene.dispatch_queued_events();
+            do_not_optimize(received);
+        });
+    });
+
+    runner.add("event/send_id", [](BenchmarkContext& context, std::uint32_t entities) {
+        Scene scene;
+
+        int received = 0;
+        scene.add_event_listener(BENCH_EVENT_ID, [&](Event& event) { received++; });
+
+        context.measure(entities, [&] {
+            for(std::uint32_t i = 0; i < entities; i++)
+                scene.send_event(BENCH_EVENT_ID);
+
+            do_not_optimize(received);
+        });
+    });
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <bench/BenchmarkRunner.hpp>
+
+// entity churn, component addition and removal, view iteration, random access and event dispatch
+void register_ecs_benchmarks(BenchmarkRunner& runner);
@@ -0,0 +1,104 @@
+/*
+3dengine_bench [--json results.json] [--compare baseline.json] [--threshold 0.1]
+               [--filter view/] [--entities 1000,100000,1000000] [--min-time 0.2]
+
+cmake -S . -B build -DENGINE_BUILD_APPLICATION=OFF -DCMAKE_BUILD_TYPE=Release
+cmake --build build --target 3dengine_bench && ./build/3dengine_bench --json baseline.json
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <bench/BenchmarkRunner.hpp>
+#include <bench/EcsBenchmarks.hpp>
+
+static std::vector<std::uint32_t> parse_entity_counts(const std::string& list) {
+    std::vector<std::uint32_t> counts;
+    std::size_t begin = 0;
+
+    while(begin < list.size()) {
+        std::size_t end = list.find(',', begin);
+        if(end == std::string::npos)
+            end = list.size();
+
+        counts.push_back(std::uint32_t(std::stoul(list.substr(begin, end - begin))));
+        begin = end + 1;
+    }
+
+    return counts;
+}
+
+int main(int argc, char** argv) {
+    std::string json_path, baseline_path, filter;
+    std::vector<std::uint32_t> entity_counts {1000, 100000, 1000000};
+    double threshold = 0.1;
+    double min_time = 0.2;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return EXIT_FAILURE;
+        }
+
+        std::string value = argv[++i];
+
+        if(arg == "--json")
+            json_path = value;
+        else if(arg == "--compare")
+            baseline_path = value;
+        else if(arg == "--threshold")
+            threshold = std::stod(value);
+        else if(arg == "--filter")
+            filter = value;
+        else if(arg == "--entities")
+            entity_counts = parse_entity_counts(value);
+        else if(arg == "--min-time")
+            min_time = std::stod(value);
+        else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    std::cout << "storage: archetype\n";
+#elif defined(ECS_CHUNKED_COMPONENT_STORAGE)
+    std::cout << "storage: sparse set (chunked)\n";
+#else
+    std::cout << "storage: sparse set\n";
+#endif
+
+    BenchmarkRunner runner;
+    register_ecs_benchmarks(runner);
+
+    std::vector<BenchmarkResult> results = runner.run(entity_counts, filter, std::chrono::duration<double>(min_time));
+
+    if(!json_path.empty() && !BenchmarkRunner::write_json(json_path, results)) {
+        std::cerr << "Could not write " << json_path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    if(!baseline_path.empty()) {
+        std::vector<BenchmarkResult> baseline;
+
+        if(!BenchmarkRunner::read_json(baseline_path, baseline)) {
+            std::cerr << "Could not read " << baseline_path << "\n";
+            return EXIT_FAILURE;
+        }
+
+        std::size_t regressions = BenchmarkRunner::compare(baseline, results, threshold);
+
+        if(regressions > 0) {
+            std::cout << regressions << " regression(s) above " << threshold * 100.0 << "%\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
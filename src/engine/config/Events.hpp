@@ -1,3 +1,5 @@
+#pragma once
+
 #include <engine/ecs/core/Types.hpp>
 #include <cstdint>
 
@@ -15,7 +17,6 @@ static constexpr std::uint32_t operator "" _hash(char const* s, std::size_t coun
 
 namespace Events::Window {
     const EventId QUIT = "Events::Window::QUIT"_hash;
-    const EventId RESIZED = "Events::Window::RESIZED"_hash;
     const EventId FOCUS_CHANGE = "Events::Window::FOCUS_CHANGE"_hash;
     const EventId GL_INIT = "Events::Window::GL_INIT"_hash;
 }
@@ -24,27 +25,33 @@ namespace Events::Window::FocusChange {
     const ParamId FOCUSED = "Events::Window::FocusChange::FOCUSED"_hash;
 }
 
-namespace Events::Window::Resized {
-    const ParamId WIDTH = "Events::Window::Resized::WIDTH"_hash;
-    const ParamId HEIGHT = "Events::Window::Resized::HEIGHT"_hash;
-}
-
 /// Input
 
 namespace Events::Input {
     const EventId KEYBOARD = "Events::Input::KEYBOARD"_hash;
-    const EventId MOUSE = "Events::Input::MOUSE"_hash;
-    const EventId SCROLL = "Events::Input::SCROLL"_hash;
 };
 
 namespace Events::Input::Keyboard {
     const ParamId KEYS = "Events::Input::Keyboard::KEYS"_hash;
 }
 
-namespace Events::Input::Mouse {
-    const ParamId MOUSE_DATA = "Events::Input::Mouse::MOUSE_DATA"_hash;
+/// Typed events (see EventManager.hpp)
+
+namespace Events::Window {
+    struct FramebufferResized {
+        int width;
+        int height;
+    };
 }
 
-namespace Events::Input::Scroll {
-    const ParamId SCROLL_DATA = "Events::Input::Scroll::SCROLL_DATA"_hash;
+namespace Events::Input {
+    struct MouseMoved {
+        double x_offset;
+        double y_offset;
+    };
+
+    struct Scrolled {
+        double x_offset;
+        double y_offset;
+    };
 }
\ No newline at end of file
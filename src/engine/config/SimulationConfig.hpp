@@ -0,0 +1,9 @@
+#pragma once
+
+struct SimulationConfig {
+    // the scene is updated in fixed steps of 1 / DEFAULT_TICK_RATE seconds (see `Application::run`)
+    static constexpr float DEFAULT_TICK_RATE = 60.0f;
+
+    // ticks simulated in one frame at most. a slower simulation drops the time it is behind
+    static constexpr unsigned int DEFAULT_MAX_TICKS_PER_FRAME = 5;
+};
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <engine/ecs/core/Types.hpp>
+
+namespace Components {
+
+// places the entity's `Transform` relative to the world transform of `entity` (see `TransformSystem`)
+struct Parent {
+    Entity entity;
+};
+
+}
\ No newline at end of file
@@ -1,11 +1,8 @@
 #pragma once
 
-#include <glm/glm.hpp>
-
 namespace Components {
 
-struct Renderable {
-    glm::vec3 color;
-};
+// tag component (see ComponentTypeId.hpp), entities with it are drawn
+struct Renderable {};
 
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <engine/ecs/core/SplitComponent.hpp>
+
 namespace Components {
 
 struct Transform {
@@ -11,4 +13,10 @@ struct Transform {
     glm::vec3 scale = glm::vec3(1.0f);
 };
 
-}
\ No newline at end of file
+}
+
+// stored as separate position, rotation and scale streams, most systems only touch the position
+template<>
+struct component_fields<Components::Transform> {
+    using type = ComponentFields<&Components::Transform::position, &Components::Transform::rotation, &Components::Transform::scale>;
+};
\ No newline at end of file
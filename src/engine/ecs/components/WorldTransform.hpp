@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Components {
+
+// world space matrices of an entity's `Transform` (and its parents'), computed by `TransformSystem`.
+// models and lights are rendered with their world transform
+struct WorldTransform {
+    glm::mat4 matrix = glm::mat4(1.0f);
+    glm::mat3 normal_matrix = glm::mat3(1.0f);
+
+    // matrix at the previous simulation tick, models are rendered between the two (see `RenderState`)
+    glm::mat4 previous_matrix = glm::mat4(1.0f);
+};
+
+}
\ No newline at end of file
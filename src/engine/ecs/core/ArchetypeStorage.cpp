@@ -0,0 +1,299 @@
+#include <engine/ecs/core/ArchetypeStorage.hpp>
+
+#include <engine/ecs/core/Types.hpp>
+
+/// Archetype
+
+Archetype::Archetype(Signature signature, const component_infos_type& component_infos):
+    m_signature{signature}, m_component_infos{&component_infos} {
+    for(ComponentType type = 0; type < MAX_COMPONENTS; type++)
+        if(m_signature.test(type))
+            m_types.push_back(type);
+
+    // start from the capacity without alignment padding and shrink until the layout fits
+    std::size_t row_bytes = sizeof(Entity);
+    for(ComponentType type : m_types)
+        row_bytes += component_infos[type].size;
+
+    m_chunk_capacity = ARCHETYPE_CHUNK_SIZE / row_bytes;
+
+    while(m_chunk_capacity > 0 && compute_layout(m_chunk_capacity) > ARCHETYPE_CHUNK_SIZE)
+        m_chunk_capacity--;
+
+    assert(m_chunk_capacity > 0 && "Archetype row does not fit in a chunk");
+
+    compute_layout(m_chunk_capacity);
+}
+
+Archetype::~Archetype() {
+    for(entity_count_size_type row = 0; row < m_size; row++)
+        destroy_row(row);
+}
+
+std::size_t Archetype::compute_layout(entity_count_size_type capacity) {
+    std::size_t offset = sizeof(Entity) * capacity; // entities are stored first
+
+    for(ComponentType type : m_types) {
+        const ComponentInfo& info = (*m_component_infos)[type];
+
+        // align column start
+        offset = (offset + info.alignment - 1) / info.alignment * info.alignment;
+        m_column_offsets[type] = offset;
+
+        offset += info.size * capacity;
+    }
+
+    return offset;
+}
+
+entity_count_size_type Archetype::push_row(Entity entity) {
+    // allocate a new chunk when all chunks are full
+    if(m_size == m_chunks.size() * m_chunk_capacity)
+        m_chunks.push_back(std::make_unique<Chunk>());
+
+    entity_count_size_type row = m_size++;
+    *reinterpret_cast<Entity*>(row_address(row, 0, sizeof(Entity))) = entity;
+
+    for(ComponentType type : m_types)
+        m_ticks[type].emplace_back();
+
+    return row;
+}
+
+Entity Archetype::fill_row_from_last(entity_count_size_type row) {
+    assert(row < m_size && "Row out of range");
+
+    entity_count_size_type last_row = m_size - 1;
+    m_size--;
+
+    if(row == last_row) {
+        for(ComponentType type : m_types)
+            m_ticks[type].pop_back();
+
+        return NO_INDEX_MARKER;
+    }
+
+    // move the last row in place of the removed row to maintain density
+    for(ComponentType type : m_types) {
+        (*m_component_infos)[type].relocate(get_component(row, type), get_component(last_row, type));
+
+        m_ticks[type][row] = m_ticks[type][last_row];
+        m_ticks[type].pop_back();
+    }
+
+    Entity moved_entity = get_entity(last_row);
+    *reinterpret_cast<Entity*>(row_address(row, 0, sizeof(Entity))) = moved_entity;
+
+    return moved_entity;
+}
+
+void Archetype::destroy_row(entity_count_size_type row) {
+    for(ComponentType type : m_types)
+        (*m_component_infos)[type].destroy(get_component(row, type));
+}
+
+void Archetype::reorder_rows(const std::vector<entity_count_size_type>& order) {
+    assert(order.size() == m_size && "Order does not cover the archetype");
+
+    // relocate the rows into new chunks in their new order, the chunks beyond the used ones are kept as they are
+    std::vector<std::unique_ptr<Chunk>> old_chunks = std::move(m_chunks);
+    std::size_t used_chunks = count_chunks();
+
+    m_chunks.clear();
+    for(std::size_t chunk = 0; chunk < used_chunks; chunk++)
+        m_chunks.push_back(std::make_unique<Chunk>());
+
+    auto old_row_address = [&](entity_count_size_type row, std::size_t column_offset, std::size_t element_size) {
+        return old_chunks[row / m_chunk_capacity]->bytes + column_offset + (row % m_chunk_capacity) * element_size;
+    };
+
+    for(entity_count_size_type row = 0; row < m_size; row++) {
+        *reinterpret_cast<Entity*>(row_address(row, 0, sizeof(Entity))) = *reinterpret_cast<Entity*>(old_row_address(order[row], 0, sizeof(Entity)));
+
+        for(ComponentType type : m_types) {
+            const ComponentInfo& info = (*m_component_infos)[type];
+            info.relocate(get_component(row, type), old_row_address(order[row], m_column_offsets[type], info.size));
+        }
+    }
+
+    for(std::size_t chunk = used_chunks; chunk < old_chunks.size(); chunk++)
+        m_chunks.push_back(std::move(old_chunks[chunk]));
+
+    for(ComponentType type : m_types) {
+        std::vector<ComponentTicks> ticks(m_size);
+
+        for(entity_count_size_type row = 0; row < m_size; row++)
+            ticks[row] = m_ticks[type][order[row]];
+
+        m_ticks[type] = std::move(ticks);
+    }
+}
+
+/// ArchetypeStorage
+
+void ArchetypeStorage::remove_component(Entity entity, ComponentType type) {
+    Signature signature = get_signature(entity);
+
+    assert(signature.test(type) && "Component does not exist for given entity");
+    signature.set(type, false);
+
+    if(signature.none()) {
+        // entity has no components left, it is no longer stored in any archetype
+        entity_destroyed(entity);
+        return;
+    }
+
+    move_entity(entity, get_or_create_archetype(signature));
+}
+
+void ArchetypeStorage::add_entities(const Entity* entities, entity_count_size_type count, Signature signature) {
+    std::size_t archetype = get_or_create_archetype(signature);
+
+    for(entity_count_size_type i = 0; i < count; i++) {
+        assert(m_entity_archetypes.get(entities[i]) == NO_INDEX_MARKER && "Entity already has components");
+
+        m_entity_archetypes.set(entities[i], archetype);
+        m_entity_rows.set(entities[i], m_archetypes[archetype]->push_row(entities[i]));
+    }
+}
+
+void ArchetypeStorage::mark_changed(Entity entity, ComponentType type) {
+    entity_count_size_type archetype = m_entity_archetypes.get(entity);
+
+    assert(archetype != NO_INDEX_MARKER && "Retrieving non existent component");
+
+    m_archetypes[archetype]->get_ticks(m_entity_rows.get(entity), type).changed = m_change_tick->load(std::memory_order_relaxed);
+}
+
+bool ArchetypeStorage::has_component(Entity entity, ComponentType type) const {
+    return get_signature(entity).test(type);
+}
+
+Signature ArchetypeStorage::get_signature(Entity entity) const {
+    entity_count_size_type archetype = m_entity_archetypes.get(entity);
+
+    return archetype != NO_INDEX_MARKER ? m_archetypes[archetype]->get_signature() : Signature{};
+}
+
+void ArchetypeStorage::entity_destroyed(Entity entity) {
+    entity_count_size_type archetype = m_entity_archetypes.get(entity);
+
+    if(archetype == NO_INDEX_MARKER)
+        return;
+
+    entity_count_size_type row = m_entity_rows.get(entity);
+
+    m_archetypes[archetype]->destroy_row(row);
+    remove_row(archetype, row);
+
+    m_entity_archetypes.reset(entity);
+    m_entity_rows.reset(entity);
+}
+
+entity_count_size_type ArchetypeStorage::count_components(ComponentType type) const {
+    entity_count_size_type count = 0;
+
+    for(const auto& archetype : m_archetypes)
+        if(archetype->get_signature().test(type))
+            count += archetype->size();
+
+    return count;
+}
+
+ComponentStats ArchetypeStorage::get_stats(ComponentType type) const {
+    ComponentStats stats;
+    stats.type = type;
+
+    for(const auto& archetype : m_archetypes) {
+        if(archetype->get_signature().test(type)) {
+            stats.count += archetype->size();
+            stats.capacity += archetype->allocated_chunks() * archetype->chunk_capacity();
+        }
+    }
+
+    // the entity column of a chunk is shared by all of its components, and is not counted here
+    std::size_t row_bytes = m_component_infos[type].size + sizeof(ComponentTicks);
+
+    stats.bytes_used = stats.count * row_bytes;
+    stats.bytes_reserved = stats.capacity * row_bytes;
+
+    return stats;
+}
+
+std::vector<Archetype*> ArchetypeStorage::get_matching_archetypes(Signature required, Signature excluded, bool exclusive) const {
+    std::vector<Archetype*> matching;
+
+    for(const auto& archetype : m_archetypes) {
+        Signature signature = archetype->get_signature();
+
+        bool matches = exclusive ? signature == required :
+            ((signature & required) == required && (signature & excluded).none());
+
+        if(matches)
+            matching.push_back(archetype.get());
+    }
+
+    return matching;
+}
+
+std::size_t ArchetypeStorage::get_or_create_archetype(Signature signature) {
+    auto it = m_archetype_indices.find(signature);
+
+    if(it != m_archetype_indices.end())
+        return it->second;
+
+    std::size_t index = m_archetypes.size();
+    m_archetypes.push_back(std::make_unique<Archetype>(signature, m_component_infos));
+    m_archetype_indices.emplace(signature, index);
+
+    return index;
+}
+
+entity_count_size_type ArchetypeStorage::move_entity(Entity entity, std::size_t destination) {
+    Archetype& destination_archetype = *m_archetypes[destination];
+    entity_count_size_type new_row = destination_archetype.push_row(entity);
+
+    entity_count_size_type source = m_entity_archetypes.get(entity);
+
+    if(source != NO_INDEX_MARKER) {
+        Archetype& source_archetype = *m_archetypes[source];
+        entity_count_size_type old_row = m_entity_rows.get(entity);
+
+        Signature source_signature = source_archetype.get_signature();
+        Signature destination_signature = destination_archetype.get_signature();
+
+        // move shared components, destroy the ones the destination does not store
+        for(ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+            if(!source_signature.test(type))
+                continue;
+
+            void* old_component = source_archetype.get_component(old_row, type);
+
+            if(destination_signature.test(type)) {
+                m_component_infos[type].relocate(destination_archetype.get_component(new_row, type), old_component);
+                destination_archetype.get_ticks(new_row, type) = source_archetype.get_ticks(old_row, type);
+            } else
+                m_component_infos[type].destroy(old_component);
+        }
+
+        remove_row(source, old_row);
+    }
+
+    m_entity_archetypes.set(entity, destination);
+    m_entity_rows.set(entity, new_row);
+
+    return new_row;
+}
+
+void ArchetypeStorage::set_added(std::size_t archetype, entity_count_size_type row, ComponentType type) {
+    change_tick_type tick = m_change_tick->load(std::memory_order_relaxed);
+
+    m_archetypes[archetype]->get_ticks(row, type) = {tick, tick};
+}
+
+void ArchetypeStorage::remove_row(std::size_t archetype, entity_count_size_type row) {
+    Entity moved_entity = m_archetypes[archetype]->fill_row_from_last(row);
+
+    if(moved_entity != NO_INDEX_MARKER)
+        m_entity_rows.set(moved_entity, row);
+}
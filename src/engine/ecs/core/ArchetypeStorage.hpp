@@ -0,0 +1,319 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/ChangeTicks.hpp>
+#include <engine/ecs/core/ComponentTypeId.hpp>
+#include <engine/ecs/core/PagedSparseArray.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// Archetype storage backend (enabled with ECS_ARCHETYPE_STORAGE)
+// Entities with the same `Signature` are kept together in an `Archetype`, which stores
+// them in fixed size chunks with a SoA layout. Iterating a query is then a linear scan
+// over the chunks of every matching archetype.
+
+// Type erased operations for a component type, so that an `Archetype` can move
+// and destroy rows without knowing the types of its columns
+struct ComponentInfo {
+    std::size_t size = 0;
+    std::size_t alignment = 0;
+
+    void (*relocate)(void* dst, void* src) = nullptr; // move construct `dst` from `src`, then destroy `src`
+    void (*destroy)(void* ptr) = nullptr;
+
+    template<typename T>
+    static ComponentInfo of();
+};
+
+template<typename T>
+ComponentInfo ComponentInfo::of() {
+    ComponentInfo info;
+
+    // tag components take no space in the chunks (see ComponentTypeId.hpp)
+    if constexpr(is_tag_component_v<T>) {
+        info.alignment = 1;
+        info.relocate = [](void*, void*) {};
+        info.destroy = [](void*) {};
+
+        return info;
+    }
+
+    info.size = sizeof(T);
+    info.alignment = alignof(T);
+    info.relocate = [](void* dst, void* src) {
+        T* src_component = static_cast<T*>(src);
+        new (dst) T(std::move(*src_component));
+        src_component->~T();
+    };
+    info.destroy = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+
+    return info;
+}
+
+using component_infos_type = std::array<ComponentInfo, MAX_COMPONENTS>;
+
+class Archetype {
+public:
+    static constexpr std::size_t CHUNK_ALIGNMENT = 64;
+
+    // chunk layout: [Entity x capacity][column 0 x capacity][column 1 x capacity]...
+    struct alignas(CHUNK_ALIGNMENT) Chunk {
+        std::byte bytes[ARCHETYPE_CHUNK_SIZE];
+    };
+
+    Archetype(Signature signature, const component_infos_type& component_infos);
+    ~Archetype();
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    Signature get_signature() const { return m_signature; }
+    entity_count_size_type size() const { return m_size; }
+
+    // Chunk access (for linear iteration)
+    entity_count_size_type chunk_capacity() const { return m_chunk_capacity; }
+    std::size_t count_chunks() const { return (m_size + m_chunk_capacity - 1) / m_chunk_capacity; }
+    std::size_t allocated_chunks() const { return m_chunks.size(); } // including the empty chunks kept for regrowth
+    entity_count_size_type chunk_size(std::size_t chunk) const;
+
+    Entity* chunk_entities(std::size_t chunk) const;
+
+    template<typename T>
+    T* chunk_column(std::size_t chunk, ComponentType type) const;
+
+    ComponentTicks* chunk_ticks(std::size_t chunk, ComponentType type);
+
+    // Row access. rows are numbered across chunks: row = chunk * chunk_capacity + index in chunk
+    const Entity& get_entity(entity_count_size_type row) const;
+    void* get_component(entity_count_size_type row, ComponentType type) const;
+    ComponentTicks& get_ticks(entity_count_size_type row, ComponentType type) { return m_ticks[type][row]; }
+
+    // append a row for `entity`, its components are left uninitialized
+    entity_count_size_type push_row(Entity entity);
+
+    // move the last row into `row`, whose components must already be moved out or destroyed.
+    // returns the entity moved into `row`, or NO_INDEX_MARKER if `row` was the last row
+    Entity fill_row_from_last(entity_count_size_type row);
+
+    // destroy the components of `row`
+    void destroy_row(entity_count_size_type row);
+
+    // move row `order[i]` to row `i`, for all rows
+    void reorder_rows(const std::vector<entity_count_size_type>& order);
+
+private:
+    std::size_t compute_layout(entity_count_size_type capacity);
+    std::byte* row_address(entity_count_size_type row, std::size_t column_offset, std::size_t element_size) const;
+
+private:
+    Signature m_signature;
+    std::vector<ComponentType> m_types; // component types stored in this archetype (ascending)
+
+    const component_infos_type* const m_component_infos;
+    std::array<std::size_t, MAX_COMPONENTS> m_column_offsets{};
+
+    entity_count_size_type m_chunk_capacity;
+    entity_count_size_type m_size = 0;
+
+    // chunks are kept allocated once created, so that churn at a chunk boundary does not allocate
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+
+    // change ticks of each stored component type, by row (kept outside the chunks)
+    std::array<std::vector<ComponentTicks>, MAX_COMPONENTS> m_ticks;
+};
+
+template<typename T>
+T* Archetype::chunk_column(std::size_t chunk, ComponentType type) const {
+    assert(m_signature.test(type) && "Component type not stored in archetype");
+
+    return reinterpret_cast<T*>(m_chunks[chunk]->bytes + m_column_offsets[type]);
+}
+
+inline ComponentTicks* Archetype::chunk_ticks(std::size_t chunk, ComponentType type) {
+    assert(m_signature.test(type) && "Component type not stored in archetype");
+
+    return m_ticks[type].data() + chunk * m_chunk_capacity;
+}
+
+inline entity_count_size_type Archetype::chunk_size(std::size_t chunk) const {
+    entity_count_size_type first_row = chunk * m_chunk_capacity;
+
+    return std::min(m_chunk_capacity, m_size - first_row);
+}
+
+inline Entity* Archetype::chunk_entities(std::size_t chunk) const {
+    return reinterpret_cast<Entity*>(m_chunks[chunk]->bytes);
+}
+
+inline std::byte* Archetype::row_address(entity_count_size_type row, std::size_t column_offset, std::size_t element_size) const {
+    return m_chunks[row / m_chunk_capacity]->bytes + column_offset + (row % m_chunk_capacity) * element_size;
+}
+
+inline const Entity& Archetype::get_entity(entity_count_size_type row) const {
+    return *reinterpret_cast<Entity*>(row_address(row, 0, sizeof(Entity)));
+}
+
+inline void* Archetype::get_component(entity_count_size_type row, ComponentType type) const {
+    assert(m_signature.test(type) && "Component type not stored in archetype");
+
+    return row_address(row, m_column_offsets[type], (*m_component_infos)[type].size);
+}
+
+class ArchetypeStorage {
+public:
+    ArchetypeStorage(const change_tick_source& change_tick): m_change_tick{&change_tick} {}
+
+    template<typename T>
+    void register_component(ComponentType type);
+
+    template<typename T>
+    void add_component(Entity entity, ComponentType type, T component);
+
+    // construct the component in place from `args`
+    template<typename T, typename ...Args>
+    T& emplace_component(Entity entity, ComponentType type, Args&& ...args);
+
+    // place entities without components in the archetype of `signature`. their components are
+    // left uninitialized, and must be constructed with `construct_component`
+    void add_entities(const Entity* entities, entity_count_size_type count, Signature signature);
+
+    template<typename T>
+    void construct_component(Entity entity, ComponentType type, const T& component);
+
+    void remove_component(Entity entity, ComponentType type);
+
+    template<typename T>
+    T& get_component(Entity entity, ComponentType type);
+
+    // change tracking
+    void mark_changed(Entity entity, ComponentType type);
+
+    bool has_component(Entity entity, ComponentType type) const;
+    Signature get_signature(Entity entity) const;
+
+    void entity_destroyed(Entity entity);
+
+    // number of entities which have a component of `type`
+    entity_count_size_type count_components(ComponentType type) const;
+
+    // count and memory of the components of `type` in all archetypes, without churn or sparse arrays
+    ComponentStats get_stats(ComponentType type) const;
+
+    std::vector<Archetype*> get_matching_archetypes(Signature required, Signature excluded, bool exclusive) const;
+
+    // sort the rows of every archetype storing `type` by `compare(const T&, const T&)`
+    template<typename T, typename Compare>
+    void sort(ComponentType type, Compare compare);
+
+private:
+    std::size_t get_or_create_archetype(Signature signature);
+
+    // move `entity` (and the components it shares with the destination) to a new row in `destination`
+    entity_count_size_type move_entity(Entity entity, std::size_t destination);
+    void remove_row(std::size_t archetype, entity_count_size_type row);
+
+    // mark the component as added (and changed) now
+    void set_added(std::size_t archetype, entity_count_size_type row, ComponentType type);
+
+private:
+    const change_tick_source* m_change_tick;
+
+    component_infos_type m_component_infos;
+
+    std::vector<std::unique_ptr<Archetype>> m_archetypes; // unique_ptr keeps archetype addresses stable
+    std::unordered_map<Signature, std::size_t> m_archetype_indices;
+
+    // entity locations: archetype index and row within the archetype
+    PagedSparseArray m_entity_archetypes;
+    PagedSparseArray m_entity_rows;
+};
+
+template<typename T>
+void ArchetypeStorage::register_component(ComponentType type) {
+    static_assert(alignof(T) <= Archetype::CHUNK_ALIGNMENT, "Component alignment exceeds chunk alignment");
+
+    m_component_infos[type] = ComponentInfo::of<T>();
+}
+
+template<typename T>
+void ArchetypeStorage::add_component(Entity entity, ComponentType type, T component) {
+    emplace_component<T>(entity, type, std::move(component));
+}
+
+template<typename T, typename ...Args>
+T& ArchetypeStorage::emplace_component(Entity entity, ComponentType type, Args&& ...args) {
+    Signature signature = get_signature(entity);
+
+    assert(!signature.test(type) && "Component added to same entity more than once.");
+    signature.set(type, true);
+
+    std::size_t destination = get_or_create_archetype(signature);
+    entity_count_size_type row = move_entity(entity, destination);
+
+    set_added(destination, row, type);
+
+    if constexpr(is_tag_component_v<T>)
+        return tag_component<T>(); // the archetype is the tag
+    else
+        return *new (m_archetypes[destination]->get_component(row, type)) T(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void ArchetypeStorage::construct_component(Entity entity, ComponentType type, const T& component) {
+    entity_count_size_type archetype = m_entity_archetypes.get(entity);
+
+    assert(archetype != NO_INDEX_MARKER && "Entity not added to storage");
+
+    entity_count_size_type row = m_entity_rows.get(entity);
+
+    if constexpr(!is_tag_component_v<T>)
+        new (m_archetypes[archetype]->get_component(row, type)) T(component);
+
+    set_added(archetype, row, type);
+}
+
+template<typename T>
+T& ArchetypeStorage::get_component(Entity entity, ComponentType type) {
+    entity_count_size_type archetype = m_entity_archetypes.get(entity);
+
+    assert(archetype != NO_INDEX_MARKER && "Retrieving non existent component");
+
+    if constexpr(is_tag_component_v<T>)
+        return tag_component<T>();
+    else
+        return *static_cast<T*>(m_archetypes[archetype]->get_component(m_entity_rows.get(entity), type));
+}
+
+
+template<typename T, typename Compare>
+void ArchetypeStorage::sort(ComponentType type, Compare compare) {
+    for(const auto& archetype : m_archetypes) {
+        if(!archetype->get_signature().test(type))
+            continue;
+
+        std::vector<entity_count_size_type> order(archetype->size());
+        std::iota(order.begin(), order.end(), 0);
+
+        std::stable_sort(order.begin(), order.end(), [&](entity_count_size_type a, entity_count_size_type b) {
+            return compare(*static_cast<const T*>(archetype->get_component(a, type)), *static_cast<const T*>(archetype->get_component(b, type)));
+        });
+
+        if(std::is_sorted(order.begin(), order.end()))
+            continue; // already in order
+
+        archetype->reorder_rows(order);
+
+        for(entity_count_size_type row = 0; row < archetype->size(); row++)
+            m_entity_rows.set(archetype->get_entity(row), row);
+    }
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/Types.hpp>
+
+// BlockPool
+// Process wide pool of fixed size blocks of uninitialized storage for `T`. Blocks given back
+// to the pool are reused by the next `BlockVector<T>` that grows, instead of being freed.
+template<typename T>
+class BlockPool {
+public:
+    // elements per block, a power of two so that indexing is a shift and a mask
+    static constexpr std::size_t BLOCK_CAPACITY = std::bit_floor(std::max<std::size_t>(COMPONENT_BLOCK_SIZE / sizeof(T), 1));
+
+    // never destroyed, so that block vectors in static objects can still return their blocks at exit
+    static BlockPool& get() {
+        static BlockPool* pool = new BlockPool;
+        return *pool;
+    }
+
+    T* allocate();
+    void deallocate(T* block);
+
+private:
+    BlockPool() = default;
+
+    std::mutex m_mutex;
+    std::vector<T*> m_free_blocks;
+};
+
+template<typename T>
+T* BlockPool<T>::allocate() {
+    {
+        std::lock_guard lock{m_mutex};
+
+        if(!m_free_blocks.empty()) {
+            T* block = m_free_blocks.back();
+            m_free_blocks.pop_back();
+
+            return block;
+        }
+    }
+
+    return static_cast<T*>(::operator new(BLOCK_CAPACITY * sizeof(T), std::align_val_t{alignof(T)}));
+}
+
+template<typename T>
+void BlockPool<T>::deallocate(T* block) {
+    std::lock_guard lock{m_mutex};
+    m_free_blocks.push_back(block);
+}
+
+// BlockVector
+// Sequence of `T` stored in fixed size blocks from `BlockPool<T>`. Growing allocates a new
+// block and never moves existing elements, so references stay valid until the element is
+// removed. `pop_back` only touches the last block, emptied blocks are kept for regrowth.
+template<typename T>
+class BlockVector {
+public:
+    using size_type = entity_count_size_type;
+
+    static constexpr std::size_t BLOCK_CAPACITY = BlockPool<T>::BLOCK_CAPACITY;
+
+    BlockVector() = default;
+    ~BlockVector();
+
+    BlockVector(const BlockVector&) = delete;
+    BlockVector& operator=(const BlockVector&) = delete;
+
+    T& operator[](size_type index) { return m_blocks[index / BLOCK_CAPACITY][index % BLOCK_CAPACITY]; }
+    const T& operator[](size_type index) const { return m_blocks[index / BLOCK_CAPACITY][index % BLOCK_CAPACITY]; }
+
+    template<typename ...Args>
+    T& emplace_back(Args&& ...args);
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void pop_back();
+
+    // grow to `count` elements, appending copies of `value`
+    void resize(size_type count, const T& value);
+
+    // append copies of `values`, one block at a time
+    void append(const T* values, size_type count);
+
+    void reserve(size_type capacity);
+    void clear(); // destroys the elements and returns the blocks to the pool
+
+    size_type size() const { return m_size; }
+    std::size_t capacity() const { return m_blocks.size() * BLOCK_CAPACITY; }
+    bool empty() const { return m_size == 0; }
+
+    // contiguous elements [block * BLOCK_CAPACITY, block * BLOCK_CAPACITY + block_size(block))
+    std::size_t count_blocks() const { return (m_size + BLOCK_CAPACITY - 1) / BLOCK_CAPACITY; }
+    T* block_data(std::size_t block) { return m_blocks[block]; }
+    const T* block_data(std::size_t block) const { return m_blocks[block]; }
+    size_type block_size(std::size_t block) const;
+
+private:
+    void add_block();
+
+private:
+    std::vector<T*> m_blocks; // allocated blocks, the ones past the last element are empty
+    size_type m_size = 0;
+};
+
+template<typename T>
+BlockVector<T>::~BlockVector() {
+    clear();
+}
+
+template<typename T>
+template<typename ...Args>
+T& BlockVector<T>::emplace_back(Args&& ...args) {
+    if(m_size == m_blocks.size() * BLOCK_CAPACITY)
+        add_block();
+
+    T* element = new (&m_blocks[m_size / BLOCK_CAPACITY][m_size % BLOCK_CAPACITY]) T(std::forward<Args>(args)...);
+    m_size++;
+
+    return *element;
+}
+
+template<typename T>
+void BlockVector<T>::pop_back() {
+    assert(m_size > 0 && "pop_back on empty BlockVector");
+
+    m_size--;
+    operator[](m_size).~T();
+}
+
+template<typename T>
+void BlockVector<T>::resize(size_type count, const T& value) {
+    assert(count >= m_size && "BlockVector::resize only grows");
+
+    reserve(count);
+
+    while(m_size < count)
+        emplace_back(value);
+}
+
+template<typename T>
+void BlockVector<T>::append(const T* values, size_type count) {
+    reserve(m_size + count);
+
+    while(count > 0) {
+        size_type offset = m_size % BLOCK_CAPACITY;
+        size_type copied = std::min<size_type>(count, BLOCK_CAPACITY - offset);
+
+        std::uninitialized_copy_n(values, copied, m_blocks[m_size / BLOCK_CAPACITY] + offset);
+
+        m_size += copied;
+        values += copied;
+        count -= copied;
+    }
+}
+
+template<typename T>
+void BlockVector<T>::reserve(size_type capacity) {
+    while(m_blocks.size() * BLOCK_CAPACITY < capacity)
+        add_block();
+}
+
+template<typename T>
+void BlockVector<T>::clear() {
+    for(size_type i = 0; i < m_size; i++)
+        operator[](i).~T();
+
+    for(T* block : m_blocks)
+        BlockPool<T>::get().deallocate(block);
+
+    m_blocks.clear();
+    m_size = 0;
+}
+
+template<typename T>
+typename BlockVector<T>::size_type BlockVector<T>::block_size(std::size_t block) const {
+    std::size_t first = block * BLOCK_CAPACITY;
+
+    return m_size - first < BLOCK_CAPACITY ? m_size - first : BLOCK_CAPACITY;
+}
+
+template<typename T>
+void BlockVector<T>::add_block() {
+    m_blocks.push_back(BlockPool<T>::get().allocate());
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Change tracking
+// `ComponentManager` keeps a scene wide change tick. Every component stores the tick at which it
+// was added and the tick at which it was last changed (through a mutable accessor, or a view
+// that takes it by non-const reference).
+//
+// A consumer of changes keeps the tick returned by its last `Scene::advance_change_tick()` and
+// selects the components added or changed since then:
+//      change_tick_type since = m_last_tick;
+//      m_last_tick = scene.advance_change_tick();
+//      SceneView<const Transform, WorldTransform>(scene, SceneViewChanged<Transform>{since}).each(...);
+
+using change_tick_type = std::uint32_t;
+using change_tick_source = std::atomic<change_tick_type>;
+
+struct ComponentTicks {
+    change_tick_type added = 0;
+    change_tick_type changed = 0;
+};
@@ -1,17 +1,69 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
-#include <array>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <lib/simple-vector/SimpleVector.hpp>
 
+#include <engine/ecs/core/BlockVector.hpp>
+#include <engine/ecs/core/ChangeTicks.hpp>
+#include <engine/ecs/core/ComponentTypeId.hpp>
+#include <engine/ecs/core/PagedSparseArray.hpp>
+#include <engine/ecs/core/SceneSnapshot.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
+#include <engine/ecs/core/SplitComponent.hpp>
 #include <engine/ecs/core/Types.hpp>
 
 // change when using `SimpleVector`
 using vector_entity_iterator = std::vector<Entity>::iterator;
 using vector_entity_const_iterator = std::vector<Entity>::const_iterator;
 
+// Components are stored in a std::vector, or with ECS_CHUNKED_COMPONENT_STORAGE in fixed size
+// blocks which are never moved, so that references to components stay valid when components
+// are added. Removing a component still moves the last component into its place.
+// Split components are stored in a `SplitVector` of std::vectors (see SplitComponent.hpp).
+template<typename T>
+struct component_vector {
+#if defined(ECS_CHUNKED_COMPONENT_STORAGE)
+    using type = BlockVector<T>;
+#else
+    using type = std::vector<T>;
+#endif
+};
+
+template<SplitComponent T>
+struct component_vector<T> { using type = SplitVector<T>; };
+
+// components which can be saved to a snapshot, which stores them as raw blocks (see SceneSnapshot.hpp):
+// trivially copyable components, or split components whose fields are all trivially copyable.
+// scenes with other component types can not be saved or loaded
+template<typename T>
+constexpr bool is_snapshot_component() {
+    if constexpr(SplitComponent<T>)
+        return SplitVector<T>::SNAPSHOT_FIELDS;
+    else
+        return std::is_trivially_copyable_v<T> && alignof(T) <= SNAPSHOT_ALIGNMENT;
+}
+
+template<typename T>
+constexpr bool is_snapshot_component_v = is_snapshot_component<T>();
+
+template<typename T>
+using component_vector_type = typename component_vector<T>::type;
+
+// bytes of one component in its `component_vector_type`
+template<typename T>
+constexpr std::size_t component_bytes() {
+    if constexpr(SplitComponent<T>)
+        return SplitVector<T>::COMPONENT_BYTES;
+    else
+        return sizeof(T);
+}
+
 // An interface class (IComponentArray) is needed so that ComponentManager
 // can store a generic ComponentArray
 class IComponentArray {
@@ -25,23 +77,124 @@ public:
     virtual entity_count_size_type size() const = 0;
 
     virtual bool has_component(Entity entity) const = 0;
+
+    // dense index of the entity's component, NO_INDEX_MARKER if it has none
+    virtual entity_count_size_type get_index(Entity entity) const = 0;
+    virtual void swap_indices(entity_count_size_type index_a, entity_count_size_type index_b) = 0;
+
+    // snapshots (see SceneSnapshot.hpp)
+    virtual bool is_snapshot_component() const = 0;
+    virtual SnapshotComponentType get_snapshot_type() const = 0;
+    virtual void write_snapshot(SnapshotWriter& writer) const = 0;
+    virtual void read_snapshot(SnapshotReader& reader, entity_count_size_type count) = 0; // replaces all components
+
+    // read the components without loading them. false if they are truncated, or if an entity is not
+    // in `entities` with this component type, or has it more than once
+    virtual bool check_snapshot(SnapshotReader& reader, entity_count_size_type count, const SnapshotEntities& entities) const = 0;
+
+    // statistics (see SceneStats.hpp), without the name of the component type
+    virtual ComponentStats get_stats() const = 0;
+    virtual void reset_churn() = 0;
+
+    // Sorting (built on `swap_indices`, so the sparse array and change ticks follow the components)
+    // move the element at `begin + order[i]` to `begin + i`
+    void apply_order(const std::vector<entity_count_size_type>& order, entity_count_size_type begin = 0);
+
+    // order the entities shared with `reference` as in `reference`, at the front of the array.
+    // iterating both arrays then walks both in the same order
+    void sort_like(IComponentArray& reference);
 };
 
+inline void IComponentArray::apply_order(const std::vector<entity_count_size_type>& order, entity_count_size_type begin) {
+    // current position of every element of the range, and the element at every position
+    std::vector<entity_count_size_type> positions(order.size());
+    std::iota(positions.begin(), positions.end(), 0);
+    std::vector<entity_count_size_type> elements = positions;
+
+    for(entity_count_size_type i = 0; i < order.size(); i++) {
+        entity_count_size_type from = positions[order[i]];
+
+        if(from == i)
+            continue;
+
+        swap_indices(begin + i, begin + from);
+
+        entity_count_size_type displaced = elements[i];
+        elements[from] = displaced;
+        positions[displaced] = from;
+        elements[i] = order[i];
+        positions[order[i]] = i;
+    }
+}
+
+inline void IComponentArray::sort_like(IComponentArray& reference) {
+    entity_count_size_type next = 0;
+
+    for(Entity entity : reference) {
+        entity_count_size_type index = get_index(entity);
+
+        if(index != NO_INDEX_MARKER)
+            swap_indices(next++, index);
+    }
+}
+
 template<typename T>
 class ComponentArray : public IComponentArray {
 public:
-    ComponentArray();
+    using reference = component_reference_t<T>; // `T&`, or a `SplitReference` for split components
+
+    ComponentArray(const change_tick_source& change_tick): m_change_tick{&change_tick} {}
 
     void insert_data(Entity entity, T component);
+
+    // construct the component in place from `args`
+    template<typename ...Args>
+    void emplace_data(Entity entity, Args&& ...args);
+
+    void insert_data(const Entity* entities, entity_count_size_type count, const T& component); // same component for all entities
     void remove_data(Entity entity);
     
     void entity_destroyed(Entity entity);
     
     bool has_component(Entity entity) const;
-    T* get_component(Entity entity) const;
-    T& get_data(Entity entity);
-    
+    T* get_component(Entity entity) requires (!SplitComponent<T>); // nullptr if entity has no component
+    reference get_data(Entity entity);
+    reference get_mutable_data(Entity entity); // marks the component as changed
+
+    reference get_data_at(entity_count_size_type index) { return m_component_vector[index]; }
+
+    // the field of all components of the array, in the order of the entities (split components only)
+    template<auto Field>
+    std::span<component_field_t<T, Field>> get_field() requires SplitComponent<T> { return m_component_vector.template get_field<Field>(); }
+
+    // change tracking
+    void mark_changed(Entity entity);
+    void mark_changed_at(entity_count_size_type index) { m_ticks[index].changed = current_tick(); }
+    const ComponentTicks& get_ticks_at(entity_count_size_type index) const { return m_ticks[index]; }
+
+    entity_count_size_type get_index(Entity entity) const;
+    void swap_indices(entity_count_size_type index_a, entity_count_size_type index_b);
+
+    // order of the components of [begin, end) sorted by `compare(const T&, const T&)` (stable),
+    // relative to `begin`. see `apply_order`
+    template<typename Compare>
+    std::vector<entity_count_size_type> sorted_order(Compare compare, entity_count_size_type begin, entity_count_size_type end) const;
+
+    // sort the components of [begin, end) in place. must not be called while the array is iterated
+    template<typename Compare>
+    void sort(Compare compare, entity_count_size_type begin = 0, entity_count_size_type end = NO_INDEX_MARKER);
+
+    bool is_snapshot_component() const { return is_snapshot_component_v<T>; }
+    SnapshotComponentType get_snapshot_type() const;
+    void write_snapshot(SnapshotWriter& writer) const;
+    void read_snapshot(SnapshotReader& reader, entity_count_size_type count);
+    bool check_snapshot(SnapshotReader& reader, entity_count_size_type count, const SnapshotEntities& entities) const;
+
+    ComponentStats get_stats() const;
+    void reset_churn() { m_churn = {}; }
+
     void clear();
+    void reserve(entity_count_size_type capacity);
 
     entity_count_size_type size() const;
 
@@ -51,21 +204,24 @@ public:
     
     vector_entity_const_iterator cbegin() const { return m_dense_entities.cbegin(); }
     vector_entity_const_iterator cend() const { return m_dense_entities.cend(); }
+private:
+    change_tick_type current_tick() const { return m_change_tick->load(std::memory_order_relaxed); }
+
 private:
     // `Entity` to `T` sparse set
-    std::array<entity_count_size_type, MAX_ENTITIES> m_sparse_array;
+    PagedSparseArray m_sparse_array;
     std::vector<Entity> m_dense_entities;
-    std::vector<T> m_component_vector;
+    component_vector_type<T> m_component_vector;
+    std::vector<ComponentTicks> m_ticks; // parallel to `m_component_vector`
+
+    const change_tick_source* m_change_tick;
+
+    ComponentChurn m_churn; // since the last `reset_churn`
 
     // SimpleVector<T, entity_count_size_type> m_component_vector;
     // SimpleVector<T, entity_count_size_type> m_dense_entities;
 };
 
-template<typename T>
-ComponentArray<T>::ComponentArray() {
-    m_sparse_array.fill(NO_COMPONENT_MARKER);
-}
-
 template<typename T>
 entity_count_size_type ComponentArray<T>::size() const {
     return m_component_vector.size();
@@ -73,21 +229,45 @@ entity_count_size_type ComponentArray<T>::size() const {
 
 template<typename T>
 void ComponentArray<T>::insert_data(Entity entity, T component) {
-    assert(!(m_component_vector.capacity() >= MAX_ENTITIES && m_component_vector.size() == MAX_ENTITIES) && "Component Array size exceeded MAX_ENTITIES");
+    emplace_data(entity, std::move(component));
+}
 
-    assert(m_sparse_array[entity] == NO_COMPONENT_MARKER && "Component added to same entity more than once.");
+template<typename T>
+template<typename ...Args>
+void ComponentArray<T>::emplace_data(Entity entity, Args&& ...args) {
+    assert(!m_sparse_array.contains(entity) && "Component added to same entity more than once.");
     
     // insert new component
     entity_count_size_type new_index = m_component_vector.size();
 
-    m_sparse_array[entity] = new_index;
+    m_sparse_array.set(entity, new_index);
     m_dense_entities.push_back(entity);
-    m_component_vector.push_back(component);
+    m_component_vector.emplace_back(std::forward<Args>(args)...);
+    m_ticks.push_back({current_tick(), current_tick()});
+
+    m_churn.adds++;
+}
+
+template<typename T>
+void ComponentArray<T>::insert_data(const Entity* entities, entity_count_size_type count, const T& component) {
+    entity_count_size_type first_index = m_component_vector.size();
+
+    for(entity_count_size_type i = 0; i < count; i++) {
+        assert(!m_sparse_array.contains(entities[i]) && "Component added to same entity more than once.");
+        m_sparse_array.set(entities[i], first_index + i);
+    }
+
+    // single allocation for each vector. for trivially copyable components the fill is a plain block copy
+    m_dense_entities.insert(m_dense_entities.end(), entities, entities + count);
+    m_component_vector.resize(m_component_vector.size() + count, component);
+    m_ticks.insert(m_ticks.end(), count, {current_tick(), current_tick()});
+
+    m_churn.adds += count;
 }
 
 template<typename T>
 void ComponentArray<T>::remove_data(Entity entity) {
-    entity_count_size_type index_removed_entity = m_sparse_array[entity];
+    entity_count_size_type index_removed_entity = m_sparse_array.get(entity);
 
     assert(index_removed_entity != NO_COMPONENT_MARKER && "Component does not exist for given entity");
 
@@ -96,53 +276,242 @@ void ComponentArray<T>::remove_data(Entity entity) {
     entity_count_size_type index_last_elem = m_component_vector.size() - 1;
     Entity entity_last_elem = m_dense_entities[index_last_elem];
 
-    // move last element in place of removed element 
-    m_sparse_array[entity_last_elem] = index_removed_entity;
-    m_dense_entities[index_removed_entity] = m_dense_entities[index_last_elem];
-    m_component_vector[index_removed_entity] = m_component_vector[index_last_elem];
+    // move last element in place of removed element, unless it is the removed element (a self move
+    // assignment leaves the component in a valid but unspecified state before it is destroyed)
+    if(index_removed_entity != index_last_elem) {
+        m_sparse_array.set(entity_last_elem, index_removed_entity);
+        m_dense_entities[index_removed_entity] = m_dense_entities[index_last_elem];
+
+        if constexpr(SplitComponent<T>)
+            m_component_vector.move_element(index_last_elem, index_removed_entity);
+        else
+            m_component_vector[index_removed_entity] = std::move(m_component_vector[index_last_elem]);
+
+        m_ticks[index_removed_entity] = m_ticks[index_last_elem];
+
+        m_churn.swap_removes++;
+    }
 
     // remove entity
-    m_sparse_array[entity] = NO_COMPONENT_MARKER;
+    m_sparse_array.reset(entity);
 
     // remove the last element
     m_dense_entities.pop_back();
     m_component_vector.pop_back();
+    m_ticks.pop_back();
+
+    m_churn.removes++;
 }
 
 template<typename T>
-T& ComponentArray<T>::get_data(Entity entity) {
-    entity_count_size_type index = m_sparse_array[entity];
+typename ComponentArray<T>::reference ComponentArray<T>::get_data(Entity entity) {
+    entity_count_size_type index = m_sparse_array.get(entity);
 
     assert(index != NO_COMPONENT_MARKER && "Retrieving non existent component");
     
-    T& component = m_component_vector[index];
+    return m_component_vector[index];
+}
+
+template<typename T>
+typename ComponentArray<T>::reference ComponentArray<T>::get_mutable_data(Entity entity) {
+    mark_changed(entity);
 
-    return component;
+    return get_data(entity);
 }
 
 template<typename T>
-T* ComponentArray<T>::get_component(Entity entity) const {
-    entity_count_size_type index = m_sparse_array[entity];
+void ComponentArray<T>::mark_changed(Entity entity) {
+    entity_count_size_type index = m_sparse_array.get(entity);
+
+    assert(index != NO_COMPONENT_MARKER && "Retrieving non existent component");
+
+    mark_changed_at(index);
+}
+
+template<typename T>
+T* ComponentArray<T>::get_component(Entity entity) requires (!SplitComponent<T>) {
+    entity_count_size_type index = m_sparse_array.get(entity);
 
     return index != NO_COMPONENT_MARKER ? &m_component_vector[index] : nullptr;
 }
 
 template<typename T>
 bool ComponentArray<T>::has_component(Entity entity) const {
-    return m_sparse_array[entity] != NO_COMPONENT_MARKER;
+    return m_sparse_array.contains(entity);
+}
+
+template<typename T>
+entity_count_size_type ComponentArray<T>::get_index(Entity entity) const {
+    return m_sparse_array.get(entity);
+}
+
+template<typename T>
+void ComponentArray<T>::swap_indices(entity_count_size_type index_a, entity_count_size_type index_b) {
+    if(index_a == index_b)
+        return;
+
+    std::swap(m_dense_entities[index_a], m_dense_entities[index_b]);
+
+    if constexpr(SplitComponent<T>)
+        m_component_vector.swap_elements(index_a, index_b);
+    else
+        std::swap(m_component_vector[index_a], m_component_vector[index_b]);
+
+    std::swap(m_ticks[index_a], m_ticks[index_b]);
+
+    m_sparse_array.set(m_dense_entities[index_a], index_a);
+    m_sparse_array.set(m_dense_entities[index_b], index_b);
+}
+
+template<typename T>
+template<typename Compare>
+std::vector<entity_count_size_type> ComponentArray<T>::sorted_order(Compare compare, entity_count_size_type begin, entity_count_size_type end) const {
+    assert(begin <= end && end <= size() && "Sort range out of bounds");
+
+    std::vector<entity_count_size_type> order(end - begin);
+    std::iota(order.begin(), order.end(), 0);
+
+    // stable, so that sorting an already sorted array moves nothing
+    std::stable_sort(order.begin(), order.end(), [&](entity_count_size_type a, entity_count_size_type b) {
+        return compare(m_component_vector[begin + a], m_component_vector[begin + b]);
+    });
+
+    return order;
+}
+
+template<typename T>
+template<typename Compare>
+void ComponentArray<T>::sort(Compare compare, entity_count_size_type begin, entity_count_size_type end) {
+    if(end == NO_INDEX_MARKER)
+        end = size();
+
+    apply_order(sorted_order(compare, begin, end), begin);
+}
+
+template<typename T>
+SnapshotComponentType ComponentArray<T>::get_snapshot_type() const {
+    return {component_type_id<T>(), sizeof(T), size()};
+}
+
+template<typename T>
+void ComponentArray<T>::write_snapshot(SnapshotWriter& writer) const {
+    writer.write_array(m_dense_entities.data(), m_dense_entities.size());
+    writer.write_array(m_ticks.data(), m_ticks.size());
+
+    if constexpr(SplitComponent<T> && is_snapshot_component_v<T>) {
+        m_component_vector.write_snapshot(writer);
+    } else if constexpr(!SplitComponent<T> && is_snapshot_component_v<T>) {
+#if defined(ECS_CHUNKED_COMPONENT_STORAGE)
+        writer.align();
+
+        for(std::size_t block = 0; block < m_component_vector.count_blocks(); block++)
+            writer.write_bytes(m_component_vector.block_data(block), m_component_vector.block_size(block) * sizeof(T));
+#else
+        writer.write_array(m_component_vector.data(), m_component_vector.size());
+#endif
+    } else {
+        assert(false && "Component type can not be saved to a snapshot, checked by Scene::save_snapshot");
+    }
+}
+
+template<typename T>
+void ComponentArray<T>::read_snapshot(SnapshotReader& reader, entity_count_size_type count) {
+    clear();
+
+    const Entity* entities = reader.read_array<Entity>(count);
+    const ComponentTicks* ticks = reader.read_array<ComponentTicks>(count);
+
+    m_dense_entities.assign(entities, entities + count);
+    m_ticks.assign(ticks, ticks + count);
+
+    for(entity_count_size_type i = 0; i < count; i++)
+        m_sparse_array.set(entities[i], i);
+
+    if constexpr(SplitComponent<T> && is_snapshot_component_v<T>) {
+        m_component_vector.read_snapshot(reader, count);
+    } else if constexpr(!SplitComponent<T> && is_snapshot_component_v<T>) {
+        const T* components = reader.read_array<T>(count);
+
+#if defined(ECS_CHUNKED_COMPONENT_STORAGE)
+        m_component_vector.append(components, count);
+#else
+        m_component_vector.assign(components, components + count);
+#endif
+    } else {
+        assert(false && "Component type can not be loaded from a snapshot, checked by Scene::load_snapshot");
+    }
+}
+
+template<typename T>
+bool ComponentArray<T>::check_snapshot(SnapshotReader& reader, entity_count_size_type count, const SnapshotEntities& entities) const {
+    const Entity* dense_entities = reader.read_array<Entity>(count);
+    reader.read_array<ComponentTicks>(count);
+
+    if constexpr(SplitComponent<T> && is_snapshot_component_v<T>)
+        component_vector_type<T>::skip_snapshot(reader, count);
+    else if constexpr(!SplitComponent<T> && is_snapshot_component_v<T>)
+        reader.read_array<T>(count);
+    else
+        return false;
+
+    if(reader.failed())
+        return false;
+
+    // the count matches the entities with the component (see `ComponentManager::check_snapshot`),
+    // so without duplicates each of them has one component
+    std::vector<Entity> sorted(dense_entities, dense_entities + count);
+    std::sort(sorted.begin(), sorted.end());
+
+    if(std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+        return false;
+
+    for(Entity entity : sorted) {
+        auto it = entities.signatures.find(entity);
+
+        if(it == entities.signatures.end() || !it->second.test(component_type_id<T>()))
+            return false;
+    }
+
+    return true;
+}
+
+template<typename T>
+ComponentStats ComponentArray<T>::get_stats() const {
+    ComponentStats stats;
+
+    stats.type = component_type_id<T>();
+    stats.count = size();
+    stats.capacity = m_component_vector.capacity();
+
+    stats.bytes_used = size() * (component_bytes<T>() + sizeof(Entity) + sizeof(ComponentTicks));
+    stats.bytes_reserved = m_component_vector.capacity() * component_bytes<T>()
+        + m_dense_entities.capacity() * sizeof(Entity) + m_ticks.capacity() * sizeof(ComponentTicks);
+
+    stats.sparse_bytes = m_sparse_array.allocated_bytes();
+    stats.churn = m_churn;
+
+    return stats;
 }
 
 template<typename T>
 void ComponentArray<T>::entity_destroyed(Entity entity) {
-    if(m_sparse_array[entity] != NO_COMPONENT_MARKER)
+    if(m_sparse_array.contains(entity))
         remove_data(entity);
 }
 
+template<typename T>
+void ComponentArray<T>::reserve(entity_count_size_type capacity) {
+    m_dense_entities.reserve(capacity);
+    m_component_vector.reserve(capacity);
+    m_ticks.reserve(capacity);
+}
+
 template<typename T>
 void ComponentArray<T>::clear() {
     for(Entity entity : m_dense_entities)
-        m_sparse_array[entity] = NO_COMPONENT_MARKER; // saves iterations by resetting only existing entities
+        m_sparse_array.reset(entity); // saves iterations by resetting only existing entities
     
     m_dense_entities.clear();
     m_component_vector.clear();
+    m_ticks.clear();
 }
\ No newline at end of file
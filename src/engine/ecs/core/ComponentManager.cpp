@@ -1,26 +1,203 @@
 #include <engine/ecs/core/ComponentManager.hpp>
 
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
 #include <engine/ecs/core/ComponentArray.hpp>
+#include <engine/ecs/core/EntityManager.hpp>
 #include <engine/ecs/core/Types.hpp>
 
 void ComponentManager::entity_destroyed(Entity entity) {
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_archetype_storage.entity_destroyed(entity);
+#else
+    for(auto& group : m_groups)
+        group->entity_removed(entity);
+
     // Notify each component array that an entity has been destroyed
     // If it has a component for that entity, it will remove it
-    for (const auto& pair : m_component_arrays) {
-        const auto& component = pair.second;
+    for(ComponentType type : m_registration_order)
+        if(m_component_arrays[type])
+            m_component_arrays[type]->entity_destroyed(entity);
+
+    // the entity's signature is reset after this, so its tags can still be read here
+    Signature tags = m_entity_manager->get_signature(entity) & m_tag_components;
+
+    for(ComponentType type = 0; tags.any(); type++) {
+        if(tags.test(type)) {
+            m_tag_counts[type]--;
+            m_tag_churn[type].removes++;
+            tags.reset(type);
+        }
+    }
+#endif
+}
+
+bool ComponentManager::entity_has_tag(Entity entity, ComponentType type) const {
+    return m_entity_manager->get_signature(entity).test(type);
+}
+
+// readable name of a type from `typeid(T).name()`
+static std::string demangle_type_name(const char* name) {
+#if defined(__GNUG__)
+    int status = 0;
+    std::unique_ptr<char, void(*)(void*)> demangled {abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free};
+
+    if(status == 0)
+        return demangled.get();
+#endif
+    return name;
+}
 
-        component->entity_destroyed(entity);
+std::vector<ComponentStats> ComponentManager::get_stats() const {
+    std::vector<ComponentStats> stats;
+    stats.reserve(m_registration_order.size());
+
+    for(ComponentType type : m_registration_order) {
+#if defined(ECS_ARCHETYPE_STORAGE)
+        ComponentStats& component_stats = stats.emplace_back(m_archetype_storage.get_stats(type));
+#else
+        ComponentStats& component_stats = stats.emplace_back();
+
+        if(m_component_arrays[type]) {
+            component_stats = m_component_arrays[type]->get_stats();
+        } else { // tags take no memory
+            component_stats.type = type;
+            component_stats.count = m_tag_counts[type];
+            component_stats.churn = m_tag_churn[type];
+        }
+#endif
+        component_stats.name = demangle_type_name(m_component_names[type]);
     }
+
+    return stats;
+}
+
+void ComponentManager::reset_churn() {
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    for(ComponentType type : m_registration_order) {
+        if(m_component_arrays[type])
+            m_component_arrays[type]->reset_churn();
+        else
+            m_tag_churn[type] = {};
+    }
+#endif
 }
 
 component_count_size_type ComponentManager::count_registered_components() const {
-    return m_component_types.size();
+    return m_registration_order.size();
 }
 
 bool ComponentManager::has_all_components(Entity entity) const {
-    for(const auto& pair : m_component_arrays)
-        if(!pair.second->has_component(entity))
+#if defined(ECS_ARCHETYPE_STORAGE)
+    return m_archetype_storage.get_signature(entity) == m_registered_components;
+#else
+    if((m_entity_manager->get_signature(entity) & m_tag_components) != m_tag_components)
+        return false;
+
+    for(ComponentType type : m_registration_order)
+        if(m_component_arrays[type] && !m_component_arrays[type]->has_component(entity))
+            return false;
+
+    return true;
+#endif
+}
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+std::vector<Archetype*> ComponentManager::get_matching_archetypes(Signature required, Signature excluded, bool exclusive) const {
+    return m_archetype_storage.get_matching_archetypes(required, excluded, exclusive);
+}
+
+void ComponentManager::add_entities(const Entity* entities, entity_count_size_type count, Signature signature) {
+    m_archetype_storage.add_entities(entities, count, signature);
+}
+#else
+std::span<const Entity> ComponentManager::get_entities(ComponentType type) {
+    if(!m_component_arrays[type])
+        return {};
+
+    return {m_component_arrays[type]->begin(), m_component_arrays[type]->end()};
+}
+
+bool ComponentManager::can_save_snapshot() const {
+    for(ComponentType type : m_registration_order)
+        if(m_component_arrays[type] && !m_component_arrays[type]->is_snapshot_component())
+            return false;
+
+    return true;
+}
+
+void ComponentManager::write_snapshot_types(SnapshotWriter& writer) const {
+    for(ComponentType type : m_registration_order) {
+        if(m_component_arrays[type])
+            writer.write(m_component_arrays[type]->get_snapshot_type());
+        else // tags are saved in the entity signatures
+            writer.write(SnapshotComponentType{type, 0, m_tag_counts[type]});
+    }
+}
+
+void ComponentManager::write_snapshot(SnapshotWriter& writer) const {
+    for(ComponentType type : m_registration_order)
+        if(m_component_arrays[type])
+            m_component_arrays[type]->write_snapshot(writer);
+}
+
+bool ComponentManager::map_snapshot_types(const std::vector<SnapshotComponentType>& types, snapshot_type_map_type& type_map) const {
+    if(types.size() != m_registration_order.size() || !can_save_snapshot())
+        return false;
+
+    // ids of the saving process which are not in the snapshot
+    type_map.fill(MAX_COMPONENTS);
+
+    // component type ids are assigned on first use, so they can differ between processes.
+    // types are matched by registration order instead
+    for(std::size_t i = 0; i < types.size(); i++) {
+        ComponentType type = m_registration_order[i];
+
+        std::uint32_t size = m_component_arrays[type] ? m_component_arrays[type]->get_snapshot_type().size : 0;
+
+        if(types[i].type >= MAX_COMPONENTS || types[i].size != size || type_map[types[i].type] != MAX_COMPONENTS)
             return false;
 
+        type_map[types[i].type] = type;
+    }
+
     return true;
-}
\ No newline at end of file
+}
+
+bool ComponentManager::check_snapshot(SnapshotReader& reader, const std::vector<SnapshotComponentType>& types, const SnapshotEntities& entities) const {
+    for(std::size_t i = 0; i < types.size(); i++) {
+        ComponentType type = m_registration_order[i];
+
+        if(types[i].count != entities.component_counts[type])
+            return false;
+
+        if(m_component_arrays[type] && !m_component_arrays[type]->check_snapshot(reader, types[i].count, entities))
+            return false;
+    }
+
+    return true;
+}
+
+void ComponentManager::read_snapshot(SnapshotReader& reader, const std::vector<SnapshotComponentType>& types, change_tick_type change_tick) {
+    for(std::size_t i = 0; i < types.size(); i++) {
+        ComponentType type = m_registration_order[i];
+
+        if(m_component_arrays[type])
+            m_component_arrays[type]->read_snapshot(reader, types[i].count);
+        else
+            m_tag_counts[type] = types[i].count;
+    }
+
+    // the owned arrays were saved with their groups packed at the front
+    for(auto& group : m_groups)
+        group->rebuild();
+
+    m_change_tick.store(change_tick, std::memory_order_relaxed);
+}
+#endif
\ No newline at end of file
@@ -1,20 +1,43 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
-#include <typeindex>
+#include <array>
+#include <span>
 #include <cassert>
 #include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
 #include <engine/ecs/core/ComponentArray.hpp>
+#include <engine/ecs/core/ArchetypeStorage.hpp>
+#include <engine/ecs/core/ChangeTicks.hpp>
+#include <engine/ecs/core/ComponentTypeId.hpp>
+#include <engine/ecs/core/OwningGroup.hpp>
+#include <engine/ecs/core/SceneSnapshot.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
 #include <engine/ecs/core/Types.hpp>
 
 // #include <lib/utilities/DebugAssert.hpp>
 
+// Components are stored in one sparse set (`ComponentArray`) per component type by default.
+// Defining ECS_ARCHETYPE_STORAGE switches to the `ArchetypeStorage` backend, which groups
+// entities with the same signature into SoA chunks.
+//
+// Storage is indexed by the static id of the component type (see ComponentTypeId.hpp),
+// so no hash map lookups are needed to reach the storage of a component type.
+//
+// Tag components (empty types) get no `ComponentArray`: an entity has a tag when the tag's bit is
+// set in its signature in `EntityManager`, which must be set before the tag is added here and
+// cleared after it is removed. Only the number of entities with each tag is kept.
+class EntityManager;
+
 class ComponentManager {
 public:
+    ComponentManager(const EntityManager& entity_manager): m_entity_manager{&entity_manager} {}
+
     template<typename T>
     void register_component();
 
@@ -23,185 +46,394 @@ public:
 
 
     template<typename T>
-    ComponentType get_component_type();
+    ComponentType get_component_type() const;
+
+    template<typename T>
+    bool is_registered() const;
 
     template<typename T>
     void add_component(Entity entity, T component);
 
+    // construct the component in place from `args`
+    template<typename T, typename ...Args>
+    component_reference_t<T> emplace_component(Entity entity, Args&& ...args);
+
+    // add the same component to many entities
+    template<typename T>
+    void add_components(const Entity* entities, entity_count_size_type count, const T& component);
+
     template<typename T>
     void remove_component(Entity entity);
 
     template<typename T>
-    T& get_component(Entity entity);
+    component_reference_t<T> get_component(Entity entity);
+
+    // change tracking (see ChangeTicks.hpp)
+    template<typename T>
+    component_reference_t<T> get_mutable_component(Entity entity); // marks the component as changed
+
+    template<typename T>
+    void mark_changed(Entity entity);
+
+    change_tick_type get_change_tick() const { return m_change_tick.load(std::memory_order_relaxed); }
+    change_tick_type advance_change_tick() { return m_change_tick.fetch_add(1, std::memory_order_relaxed) + 1; }
 
 
+    // sort the components of type T by `compare(const T&, const T&)`. the packed range of an
+    // owning group of T is sorted on its own, and the other arrays of the group follow it
+    template<typename T, typename Compare>
+    void sort(Compare compare);
+
+    // order the components of type T as the components of type `Reference`
+    template<typename T, typename Reference>
+    void sort_like();
+
     template<typename ...ComponentTypes>
-    Signature get_signature();
+    Signature get_signature() const;
 
 
     template<typename T>
     bool has_component(Entity entity);
-    
+
     bool has_all_components(Entity entity) const;
 
     void entity_destroyed(Entity entity);
 
-    
+
     component_count_size_type count_registered_components() const;
-    
+
     template<typename T>
     entity_count_size_type size_component_array() const;
 
+    // statistics of the registered component types, in registration order (see SceneStats.hpp)
+    std::vector<ComponentStats> get_stats() const;
+    void reset_churn();
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    std::vector<Archetype*> get_matching_archetypes(Signature required, Signature excluded, bool exclusive) const;
 
+    // move entities without components to the archetype of `signature` before `add_components`
+    // is called with each of its component types
+    void add_entities(const Entity* entities, entity_count_size_type count, Signature signature);
+#else
+    // nullptr for tag component types
+    template<typename T>
+    ComponentArray<std::remove_cvref_t<T>>* get_component_array();
+
+    // entities with a component of `type`, in the order of its array. empty for tag component types
+    std::span<const Entity> get_entities(ComponentType type);
+
+    // owning group of the component types, created on first use
     template<typename ...ComponentTypes>
-    std::pair<vector_entity_iterator, vector_entity_iterator> get_smallest_component_array();
+    OwningGroup& get_owning_group();
+
+    // snapshots (see SceneSnapshot.hpp)
+    bool can_save_snapshot() const; // false if a registered component type is not `is_snapshot_component_v`
+    void write_snapshot_types(SnapshotWriter& writer) const;
+    void write_snapshot(SnapshotWriter& writer) const;
+
+    // false if the snapshot's component types are not the registered component types, or if they can not be loaded
+    bool map_snapshot_types(const std::vector<SnapshotComponentType>& types, snapshot_type_map_type& type_map) const;
+    void read_snapshot(SnapshotReader& reader, const std::vector<SnapshotComponentType>& types, change_tick_type change_tick);
+
+    // read the components of a snapshot without loading them. false if they are truncated or do not
+    // match the snapshot's entities
+    bool check_snapshot(SnapshotReader& reader, const std::vector<SnapshotComponentType>& types, const SnapshotEntities& entities) const;
+#endif
 
 private:
-    template<typename T>
-    ComponentArray<T>* get_component_array();
+    bool entity_has_tag(Entity entity, ComponentType type) const;
 
 private:
-    std::unordered_map<std::type_index, ComponentType> m_component_types;
-    std::unordered_map<std::type_index, std::unique_ptr<IComponentArray>> m_component_arrays;
+    const EntityManager* const m_entity_manager;
+
+    Signature m_registered_components;
+    std::vector<ComponentType> m_registration_order;
+    std::array<const char*, MAX_COMPONENTS> m_component_names{}; // mangled type names, for statistics
+
+    Signature m_tag_components;
+    std::array<entity_count_size_type, MAX_COMPONENTS> m_tag_counts{}; // entities with each tag
+    std::array<ComponentChurn, MAX_COMPONENTS> m_tag_churn{};
+
+    change_tick_source m_change_tick = 1;
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    ArchetypeStorage m_archetype_storage {m_change_tick};
+#else
+    std::array<std::unique_ptr<IComponentArray>, MAX_COMPONENTS> m_component_arrays;
 
-    ComponentType m_next_component_type{};
+    std::vector<std::unique_ptr<OwningGroup>> m_groups;
+    std::array<OwningGroup*, MAX_COMPONENTS> m_owning_groups{}; // group owning each component type, if any
+#endif
 };
 
 template<typename ...ComponentTypes>
-Signature ComponentManager::get_signature() {
-    Signature signature;
-    
-    if(sizeof...(ComponentTypes) == 0)
-        // set signature for all registered component types
-        for(auto pair : m_component_types)
-            signature.set(pair.second, true);
+Signature ComponentManager::get_signature() const {
+    if constexpr(sizeof...(ComponentTypes) == 0)
+        // signature for all registered component types
+        return m_registered_components;
     else
-        // get signature for requested component types
-        (signature.set(get_component_type<ComponentTypes>(), true), ...);
-
-    return signature;
+        // signature for requested component types
+        return component_signature<ComponentTypes...>();
 }
 
-template<typename ...ComponentTypes>
-std::pair<vector_entity_iterator, vector_entity_iterator> ComponentManager::get_smallest_component_array() {
-    if(sizeof...(ComponentTypes) == 0) { // if no component types specified, check all component types
-        auto it = std::min_element( m_component_arrays.begin(), m_component_arrays.end(), 
-            [](const auto& pair1, const auto& pair2) { return pair1.second->size() < pair2.second->size(); } );
-        
-        // ASSERT(it->second->size() > 0, "Empty component array: " << it->first.name());
-
-        // In case of empty vector, begin() iterator is equal to end() 
-        return std::make_pair(it->second->begin(), it->second->end());
-    } else {
-        std::vector<std::type_index> requested_types;
-        (requested_types.push_back(typeid(ComponentTypes)), ...);
+template<typename T>
+entity_count_size_type ComponentManager::size_component_array() const {
+    assert(is_registered<T>() && "Component not registered.");
 
-        entity_count_size_type min_components = MAX_ENTITIES;
-        
-        std::type_index min_type = requested_types[0];
-        IComponentArray* comp_array_ptr;
+#if defined(ECS_ARCHETYPE_STORAGE)
+    return m_archetype_storage.count_components(component_type_id<T>());
+#else
+    if constexpr(is_tag_component_v<T>)
+        return m_tag_counts[component_type_id<T>()];
+    else
+        return m_component_arrays[component_type_id<T>()]->size();
+#endif
+}
 
-        for(std::type_index type : requested_types) {
-            entity_count_size_type comp_array_size = m_component_arrays[type]->size();
+#if !defined(ECS_ARCHETYPE_STORAGE)
+template<typename T>
+ComponentArray<std::remove_cvref_t<T>>* ComponentManager::get_component_array() {
+    assert(is_registered<T>() && "Component not registered before use.");
 
-            if(comp_array_size < min_components) {
-                min_components = comp_array_size;
-                min_type = type;
-                comp_array_ptr = m_component_arrays[type].get();
-            }
-        }
+    if constexpr(is_tag_component_v<T>)
+        return nullptr;
+    else
+        return static_cast<ComponentArray<std::remove_cvref_t<T>>*>(m_component_arrays[component_type_id<T>()].get());
+}
 
-        // ASSERT(comp_array_ptr->size() > 0, "Empty component array: " << min_type.name());
+template<typename ...ComponentTypes>
+OwningGroup& ComponentManager::get_owning_group() {
+    static_assert(sizeof...(ComponentTypes) > 0, "Group must own at least one component type");
 
-        return std::make_pair(comp_array_ptr->begin(), comp_array_ptr->end());
-    }
-}
+    using first_type = std::tuple_element_t<0, std::tuple<ComponentTypes...>>;
+    Signature owned = get_signature<ComponentTypes...>();
 
-template<typename T>
-entity_count_size_type ComponentManager::size_component_array() const {
-    std::type_index type = typeid(T);
+    if(OwningGroup* group = m_owning_groups[get_component_type<first_type>()]) {
+        assert(group->get_signature() == owned && "Component type is already owned by another group");
 
-    auto it = m_component_arrays.begin();
-    assert(((it = m_component_arrays.find(type)) != m_component_arrays.end()) && "Component not registered.");
+        return *group;
+    }
 
-    return it->second->size();   
-}
+    assert(((!m_owning_groups[get_component_type<ComponentTypes>()]) && ...) && "Component type is already owned by another group");
 
-// Private Methods
-template<typename T>
-ComponentArray<T>* ComponentManager::get_component_array() {
-    std::type_index type = typeid(T);
+    // the arrays of the types which are not tags
+    std::vector<IComponentArray*> component_arrays;
+    ((is_tag_component_v<ComponentTypes> || (component_arrays.push_back(get_component_array<ComponentTypes>()), true)), ...);
 
-    assert(m_component_types.find(type) != m_component_types.end() && "Component not registered before use.");
+    auto& group = m_groups.emplace_back(std::make_unique<OwningGroup>(owned, std::move(component_arrays), owned & m_tag_components, *m_entity_manager));
+    ((m_owning_groups[component_type_id<ComponentTypes>()] = group.get()), ...);
 
-    return static_cast<ComponentArray<T>*>(m_component_arrays[type].get());
+    return *group;
 }
+#endif
 
 // Public Methods
 template<typename T>
 void ComponentManager::register_component() {
-    std::type_index type = typeid(T);
+    assert(!is_registered<T>() && "Registering component more than once");
 
-    assert(m_component_types.find(type) == m_component_types.end() && "Registering component more than once");
+    ComponentType type = component_type_id<T>();
 
-    // add the component type to the component type map
-    m_component_types.insert({type, m_next_component_type});
-    
-    m_component_arrays.emplace(type, std::make_unique<ComponentArray<T>>());
+    m_registered_components.set(type, true);
+    m_registration_order.push_back(type);
+    m_component_names[type] = typeid(T).name();
 
-    // increment the value so that next component will be registered different
-    ++m_next_component_type;
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_archetype_storage.register_component<T>(type);
+#else
+    if constexpr(is_tag_component_v<T>) {
+        m_tag_components.set(type, true);
+        m_tag_counts[type] = 0;
+        m_tag_churn[type] = {};
+    } else {
+        m_component_arrays[type] = std::make_unique<ComponentArray<T>>(m_change_tick);
+    }
+#endif
 }
 
 // deregister this component array and all its components
 // the systems previously using these components, must update their signatures
 template<typename T>
 void ComponentManager::deregister_and_clear_component_array() {
-    std::type_index type = typeid(T);
+    ComponentType type = component_type_id<T>();
 
-    auto it1 = m_component_arrays.find(type);
+#if defined(ECS_ARCHETYPE_STORAGE)
+    static_assert(sizeof(T) == 0, "Deregistering components is not supported by the archetype storage backend");
+#else
+    assert(!m_owning_groups[type] && "Deregistering a component type owned by a group");
 
-    if(it1 != m_component_arrays.end()) {
-        ComponentArray<T>* component_array_ptr = static_cast<ComponentArray<T>*>(it1->second.get());
-        component_array_ptr->Clear(); // clear component array data
+    if(m_component_arrays[type]) {
+        get_component_array<T>()->clear(); // clear component array data
 
-        m_component_arrays.erase(it1);
+        m_component_arrays[type].reset();
     }
-    
-    auto it2 = m_component_types.find(type);
-    if(it2 != m_component_types.end())
-        m_component_types.erase(it2);
+
+    m_tag_components.set(type, false);
+    m_tag_counts[type] = 0;
+    m_tag_churn[type] = {};
+#endif
+
+    m_registered_components.set(type, false);
+    m_registration_order.erase(std::remove(m_registration_order.begin(), m_registration_order.end(), type), m_registration_order.end());
 }
 
 template<typename T>
-ComponentType ComponentManager::get_component_type() {
-    std::type_index type = typeid(T);
+ComponentType ComponentManager::get_component_type() const {
+    assert(is_registered<T>() && "Component not registered before use");
 
-    auto it = m_component_types.begin();
-    assert((it = m_component_types.find(type)) != m_component_types.end() && "Component not registered before use");
-    
     // return this component's type - used for creating signatures
-    return it->second;
+    return component_type_id<T>();
+}
+
+template<typename T>
+bool ComponentManager::is_registered() const {
+    return m_registered_components.test(component_type_id<T>());
 }
 
 template<typename T>
 void ComponentManager::add_component(Entity entity, T component) {
+    emplace_component<T>(entity, std::move(component));
+}
+
+template<typename T, typename ...Args>
+component_reference_t<T> ComponentManager::emplace_component(Entity entity, Args&& ...args) {
     // add a component to the array for an entity
-    get_component_array<T>()->insert_data(entity, component);
+#if defined(ECS_ARCHETYPE_STORAGE)
+    return m_archetype_storage.emplace_component<T>(entity, get_component_type<T>(), std::forward<Args>(args)...);
+#else
+    if constexpr(is_tag_component_v<T>) {
+        assert(entity_has_tag(entity, component_type_id<T>()) && "Tag must be set in the entity signature before it is added");
+        m_tag_counts[component_type_id<T>()]++;
+        m_tag_churn[component_type_id<T>()].adds++;
+
+        if(OwningGroup* group = m_owning_groups[component_type_id<T>()])
+            group->entity_added(entity);
+
+        return tag_component<T>();
+    } else {
+        ComponentArray<T>* component_array = get_component_array<T>();
+        component_array->emplace_data(entity, std::forward<Args>(args)...);
+
+        // the group may move the component into its packed range
+        if(OwningGroup* group = m_owning_groups[component_type_id<T>()])
+            group->entity_added(entity);
+
+        return component_array->get_data(entity);
+    }
+#endif
+}
+
+template<typename T>
+void ComponentManager::add_components(const Entity* entities, entity_count_size_type count, const T& component) {
+#if defined(ECS_ARCHETYPE_STORAGE)
+    ComponentType type = get_component_type<T>();
+
+    for(entity_count_size_type i = 0; i < count; i++)
+        m_archetype_storage.construct_component<T>(entities[i], type, component);
+#else
+    if constexpr(is_tag_component_v<T>) {
+        m_tag_counts[component_type_id<T>()] += count;
+        m_tag_churn[component_type_id<T>()].adds += count;
+    } else {
+        get_component_array<T>()->insert_data(entities, count, component);
+    }
+
+    if(OwningGroup* group = m_owning_groups[component_type_id<T>()])
+        for(entity_count_size_type i = 0; i < count; i++)
+            group->entity_added(entities[i]);
+#endif
 }
 
 template<typename T>
 void ComponentManager::remove_component(Entity entity) {
     // remove a component from the array for an entity
-    get_component_array<T>()->remove_data(entity);
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_archetype_storage.remove_component(entity, get_component_type<T>());
+#else
+    if(OwningGroup* group = m_owning_groups[component_type_id<T>()])
+        group->entity_removed(entity); // take the entity out of the group before its component is removed
+
+    if constexpr(is_tag_component_v<T>) {
+        assert(entity_has_tag(entity, component_type_id<T>()) && "Removing non-existent component.");
+        m_tag_counts[component_type_id<T>()]--;
+        m_tag_churn[component_type_id<T>()].removes++;
+    } else {
+        get_component_array<T>()->remove_data(entity);
+    }
+#endif
 }
 
 template<typename T>
-T& ComponentManager::get_component(Entity entity) {
-    return get_component_array<T>()->get_data(entity);
+component_reference_t<T> ComponentManager::get_component(Entity entity) {
+#if defined(ECS_ARCHETYPE_STORAGE)
+    return m_archetype_storage.get_component<T>(entity, get_component_type<T>());
+#else
+    if constexpr(is_tag_component_v<T>) {
+        assert(entity_has_tag(entity, component_type_id<T>()) && "Retrieving non-existent component.");
+        return tag_component<T>();
+    } else {
+        return get_component_array<T>()->get_data(entity);
+    }
+#endif
+}
+
+template<typename T>
+component_reference_t<T> ComponentManager::get_mutable_component(Entity entity) {
+    mark_changed<T>(entity);
+
+    return get_component<T>(entity);
+}
+
+template<typename T>
+void ComponentManager::mark_changed(Entity entity) {
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_archetype_storage.mark_changed(entity, get_component_type<T>());
+#else
+    if constexpr(!is_tag_component_v<T>)
+        get_component_array<T>()->mark_changed(entity);
+#endif
 }
 
 template<typename T>
 bool ComponentManager::has_component(Entity entity) {
-    return get_component_array<T>()->has_component(entity);
-}
\ No newline at end of file
+#if defined(ECS_ARCHETYPE_STORAGE)
+    return m_archetype_storage.has_component(entity, get_component_type<T>());
+#else
+    if constexpr(is_tag_component_v<T>)
+        return entity_has_tag(entity, get_component_type<T>());
+    else
+        return get_component_array<T>()->has_component(entity);
+#endif
+}
+
+
+template<typename T, typename Compare>
+void ComponentManager::sort(Compare compare) {
+    static_assert(!is_tag_component_v<T>, "Tag components have no order");
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_archetype_storage.sort<T>(get_component_type<T>(), compare);
+#else
+    ComponentArray<T>* component_array = get_component_array<T>();
+
+    if(OwningGroup* group = m_owning_groups[component_type_id<T>()]) {
+        group->apply_order(component_array->sorted_order(compare, 0, group->size()));
+        component_array->sort(compare, group->size(), component_array->size());
+    } else {
+        component_array->sort(compare);
+    }
+#endif
+}
+
+template<typename T, typename Reference>
+void ComponentManager::sort_like() {
+    static_assert(!is_tag_component_v<T> && !is_tag_component_v<Reference>, "Tag components have no order");
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    assert(!m_owning_groups[component_type_id<T>()] && "Sorting a component type owned by a group");
+
+    get_component_array<T>()->sort_like(*get_component_array<Reference>());
+#endif
+    // the rows of an archetype store all of its components in the same order already
+}
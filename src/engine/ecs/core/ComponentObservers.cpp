@@ -0,0 +1,81 @@
+#include <engine/ecs/core/ComponentObservers.hpp>
+
+#include <algorithm>
+#include <utility>
+
+#include <engine/ecs/core/Types.hpp>
+
+void ComponentObservers::add_observer(ComponentEvent event, ComponentType type, observer_type observer) {
+    bool observed = false;
+
+    for(const auto& event_observed : m_observed)
+        observed = observed || event_observed.test(type);
+
+    if(!observed)
+        m_observed_types.push_back(type);
+
+    m_observed[event].set(type, true);
+    m_observers[event][type].observers.push_back(std::move(observer));
+}
+
+void ComponentObservers::record_observed(ComponentEvent event, ComponentType type, Entity entity) {
+    if(event == COMPONENT_CHANGED) {
+        std::lock_guard lock{m_changed_mutex};
+        m_observers[event][type].recorded.push_back(entity);
+    } else {
+        m_observers[event][type].recorded.push_back(entity);
+    }
+}
+
+void ComponentObservers::record(ComponentEvent event, ComponentType type, const Entity* entities, entity_count_size_type count) {
+    if(!is_observed(event, type))
+        return;
+
+    std::unique_lock lock{m_changed_mutex, std::defer_lock};
+
+    if(event == COMPONENT_CHANGED)
+        lock.lock();
+
+    std::vector<Entity>& recorded = m_observers[event][type].recorded;
+    recorded.insert(recorded.end(), entities, entities + count);
+}
+
+void ComponentObservers::record(ComponentEvent event, Signature signature, const Entity* entities, entity_count_size_type count) {
+    signature &= m_observed[event];
+
+    if(signature.none())
+        return;
+
+    for(ComponentType type : m_observed_types)
+        if(signature.test(type))
+            record(event, type, entities, count);
+}
+
+void ComponentObservers::flush() {
+    // take all recorded events first, so that the events recorded by the observers wait for the next flush
+    for(ComponentType type : m_observed_types) {
+        for(auto& event_observers : m_observers) {
+            Observers& observers = event_observers[type];
+            std::swap(observers.recorded, observers.delivering);
+        }
+
+        // deliver each changed entity once
+        std::vector<Entity>& changed = m_observers[COMPONENT_CHANGED][type].delivering;
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    }
+
+    for(ComponentType type : m_observed_types) {
+        for(auto& event_observers : m_observers) {
+            Observers& observers = event_observers[type];
+
+            if(observers.delivering.empty())
+                continue;
+
+            for(const observer_type& observer : observers.observers)
+                observer(observers.delivering);
+
+            observers.delivering.clear(); // keeps the memory for the next flush
+        }
+    }
+}
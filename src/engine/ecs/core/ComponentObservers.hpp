@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <engine/ecs/core/Types.hpp>
+
+// Component observers
+// Callbacks on the additions, removals and changes of the components of a type, so that derived
+// structures (spatial indexes, instance lists, broadphase proxies) can be updated incrementally
+// instead of being rebuilt from a view every frame:
+//      scene.on_added<Components::Model>([&](const std::vector<Entity>& entities) { ... });
+//
+// Events are recorded as they happen and delivered in batches by `Scene::flush_observers`, which
+// `Scene::update` calls once the command buffers are played back. Types are flushed in the order
+// they were first observed, and for each type the removed, then the added, then the changed
+// entities are delivered, so that an entity id which was destroyed and reused is removed first.
+//  - added: `add_component`, `emplace_component`, `add_components` and `create_entities`
+//  - removed: `remove_component` and `destroy_entity`. the components are gone by the flush
+//  - changed: `get_mutable_component`, `mark_changed`, and the components of non-const types passed
+//    to `SceneView::each`, `SceneView::parallel_each` and `Group::each`, which may run on worker
+//    threads. an entity is delivered once per flush
+//
+// An entity can be in several batches of one flush (e.g. added and then removed again), so the
+// observers of added and changed components should check that the entity still has the component
+// with `has_component`. Loading a snapshot is not observed.
+// Events recorded while observers run are delivered by the next flush.
+class ComponentObservers {
+public:
+    using observer_type = std::function<void(const std::vector<Entity>& entities)>;
+
+    enum ComponentEvent {
+        COMPONENT_REMOVED,
+        COMPONENT_ADDED,
+        COMPONENT_CHANGED,
+        COMPONENT_EVENT_COUNT
+    };
+
+    void add_observer(ComponentEvent event, ComponentType type, observer_type observer);
+
+    bool is_observed(ComponentEvent event, ComponentType type) const { return m_observed[event].test(type); }
+    Signature get_observed(ComponentEvent event) const { return m_observed[event]; }
+
+    // record the event if the type is observed. thread safe for COMPONENT_CHANGED
+    void record(ComponentEvent event, ComponentType type, Entity entity);
+    void record(ComponentEvent event, ComponentType type, const Entity* entities, entity_count_size_type count);
+
+    // record the events of the observed types of `signature` for the entities. thread safe for COMPONENT_CHANGED,
+    // so that views iterated in parallel can merge the changes of each chunk
+    void record(ComponentEvent event, Signature signature, const Entity* entities, entity_count_size_type count);
+
+    // deliver the events recorded since the last flush
+    void flush();
+
+private:
+    void record_observed(ComponentEvent event, ComponentType type, Entity entity);
+
+    struct Observers {
+        std::vector<observer_type> observers;
+        std::vector<Entity> recorded;   // since the last flush
+        std::vector<Entity> delivering; // taken from `recorded` by the current flush
+    };
+
+private:
+    std::array<Signature, COMPONENT_EVENT_COUNT> m_observed;
+    std::array<std::array<Observers, MAX_COMPONENTS>, COMPONENT_EVENT_COUNT> m_observers;
+    std::vector<ComponentType> m_observed_types; // in order of their first observer
+
+    std::mutex m_changed_mutex; // changes are recorded by systems running in parallel
+};
+
+// inline, so that recording the events of types without observers costs one bit test
+inline void ComponentObservers::record(ComponentEvent event, ComponentType type, Entity entity) {
+    if(is_observed(event, type))
+        record_observed(event, type, entity);
+}
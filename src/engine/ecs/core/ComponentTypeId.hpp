@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <type_traits>
+
+#include <lib/utilities/TypeId.hpp>
+
+#include <engine/ecs/core/Types.hpp>
+
+// Component types are identified by a static id, which is also the bit used for the
+// component in a `Signature` and the index of its storage in `ComponentManager`.
+// Ids are assigned at runtime, on the first use of each type, from one counter shared by all
+// scenes of the process. The process aborts when more than MAX_COMPONENTS types are used.
+struct ComponentFamily {};
+
+template<typename T>
+ComponentType component_type_id() {
+    static const ComponentType id = [] {
+        std::size_t id = FamilyTypeId<ComponentFamily>::get<std::remove_cvref_t<T>>();
+
+        // every storage indexed by component type would be overrun, in release builds too
+        if(id >= MAX_COMPONENTS) {
+            std::cerr << "Number of component types exceeds MAX_COMPONENTS (" << MAX_COMPONENTS << ")" << std::endl;
+            std::abort();
+        }
+
+        return static_cast<ComponentType>(id);
+    }();
+
+    return id;
+}
+
+// Signature of a set of component types. computed once per set of types and cached
+template<typename ...ComponentTypes>
+const Signature& component_signature() {
+    static const Signature signature = [] {
+        Signature signature;
+        (signature.set(component_type_id<ComponentTypes>(), true), ...);
+
+        return signature;
+    }();
+
+    return signature;
+}
+
+// Tag components
+// Empty component types only mark entities. They are stored as the bit of the entity's
+// signature, without any component storage, and have no change ticks.
+template<typename T>
+constexpr bool is_tag_component_v = std::is_empty_v<std::remove_cvref_t<T>>;
+
+// all components of a tag type are the same object
+template<typename T>
+T& tag_component() {
+    static_assert(is_tag_component_v<T>, "Not a tag component type");
+
+    static std::remove_cvref_t<T> tag;
+    return tag;
+}
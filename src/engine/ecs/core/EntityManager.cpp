@@ -1,24 +1,31 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_set>
+#include <utility>
 
 #include <engine/ecs/core/EntityManager.hpp>
 
-#include <lib/utilities/DebugAssert.hpp>
 #include <engine/ecs/core/Types.hpp>
 
-EntityManager::EntityManager() {
-    m_sparse_array.fill(NO_SIGNATURE_MARKER);
+EntityManager::EntityManager(entity_count_size_type max_entities) {
+    set_max_entities(max_entities);
 }
 
 Entity EntityManager::create_entity() {
     Entity entity;
 
-    if(last_entity < MAX_ENTITIES)
-        entity = last_entity++;
-    else if(destroyed_entities.size()) {
+    // reuse destroyed entities first, keeping the range of entity ids (and so the
+    // number of sparse pages allocated by every component array) as small as possible
+    if(destroyed_entities.size()) {
         entity = destroyed_entities.front();
         destroyed_entities.pop();
-    } else
-        ASSERT_MESSAGE("Too many entities");
+    } else {
+        reserve_new_ids(1);
+        entity = last_entity++;
+    }
 
     // add zero initialized Signature for new entity
     set_signature(entity, {});
@@ -26,10 +33,40 @@ Entity EntityManager::create_entity() {
     return entity;
 }
 
+std::vector<Entity> EntityManager::create_entities(entity_count_size_type count, Signature signature) {
+    if(count > destroyed_entities.size())
+        reserve_new_ids(count - destroyed_entities.size());
+
+    std::vector<Entity> entities;
+    entities.reserve(count);
+
+    // reuse destroyed entities first, then take a range of new ids
+    while(entities.size() < count && destroyed_entities.size()) {
+        entities.push_back(destroyed_entities.front());
+        destroyed_entities.pop();
+    }
+
+    while(entities.size() < count)
+        entities.push_back(last_entity++);
+
+    // write the signatures in bulk
+    m_dense_entities.reserve(m_dense_entities.size() + count);
+    m_dense_signatures.insert(m_dense_signatures.end(), count, signature);
+
+    for(Entity entity : entities) {
+        m_sparse_array.set(entity, m_dense_entities.size());
+        m_dense_entities.push_back(entity);
+    }
+
+    m_query_cache.entities_created(entities.data(), count, signature);
+
+    return entities;
+}
+
 void EntityManager::destroy_entity(Entity entity) {
-    assert(entity < MAX_ENTITIES && "Entity out of range");
+    assert(entity < last_entity && "Entity out of range");
 
-    entity_count_size_type removed_index = m_sparse_array[entity];
+    entity_count_size_type removed_index = m_sparse_array.get(entity);
 
     assert(removed_index != NO_SIGNATURE_MARKER && "Entity does not exist");
 
@@ -37,8 +74,10 @@ void EntityManager::destroy_entity(Entity entity) {
     entity_count_size_type last_entity = m_dense_entities[last_index];
 
     // update sparse array
-    m_sparse_array[last_entity] = removed_index;
-    m_sparse_array[entity] = NO_SIGNATURE_MARKER;
+    m_sparse_array.set(last_entity, removed_index);
+    m_sparse_array.reset(entity);
+
+    m_query_cache.entity_destroyed(entity, m_dense_signatures[removed_index]);
 
     // copy last elements to removed index
     m_dense_entities[removed_index] = m_dense_entities[last_index];
@@ -47,35 +86,203 @@ void EntityManager::destroy_entity(Entity entity) {
     // remove last element
     m_dense_signatures.pop_back();
     m_dense_entities.pop_back();
-    
+
     // update destroyed_entities
     destroyed_entities.push(entity);
 }
 
 void EntityManager::set_signature(Entity entity, Signature signature) {
-    assert(entity < MAX_ENTITIES && "Entity out of range");
+    assert(entity < m_max_entities && "Entity out of range");
     
-    entity_count_size_type index = m_sparse_array[entity];
+    entity_count_size_type index = m_sparse_array.get(entity);
 
     if(index == NO_SIGNATURE_MARKER) {
-        m_sparse_array[entity] = m_dense_entities.size();
+        m_sparse_array.set(entity, m_dense_entities.size());
         m_dense_entities.push_back(entity);
         m_dense_signatures.push_back(signature);
+
+        m_query_cache.entities_created(&entity, 1, signature);
     } else {
+        m_query_cache.signature_changed(entity, m_dense_signatures[index], signature);
         m_dense_signatures[index] = signature;
     }
 }
 
-Signature EntityManager::get_signature(Entity entity) {
-    assert(entity < MAX_ENTITIES && "Entities out of range");
+Signature EntityManager::get_signature(Entity entity) const {
+    assert(entity < m_max_entities && "Entities out of range");
+
+    return m_dense_signatures[m_sparse_array.get(entity)];
+}
+
+Query& EntityManager::get_query(Signature required, Signature excluded, bool exclusive,
+    const QueryCache::component_entities_type& component_entities) {
+    return m_query_cache.get_query(required, excluded, exclusive, m_dense_entities, m_dense_signatures, component_entities);
+}
+
+void EntityManager::order_queries(ComponentType type, std::span<const Entity> entities) {
+    m_query_cache.order_queries(type, entities);
+}
+
+void EntityManager::reserve_new_ids(entity_count_size_type count) {
+    if(count <= m_max_entities - last_entity)
+        return;
+
+    // NO_INDEX_MARKER can not be a valid entity
+    std::uint64_t required = std::uint64_t(last_entity) + count;
+
+    if(required >= NO_INDEX_MARKER) {
+        std::cerr << "Entity ids exhausted" << std::endl;
+        std::abort();
+    }
+
+    // sparse pages are only allocated for the ids in use, so growing the capacity costs nothing
+    std::uint64_t grown = std::max<std::uint64_t>(required, std::uint64_t(m_max_entities) * 2);
+    m_max_entities = std::min<std::uint64_t>(grown, NO_INDEX_MARKER - 1);
+}
+
+void EntityManager::set_max_entities(entity_count_size_type max_entities) {
+    // NO_INDEX_MARKER can not be a valid entity
+    assert(max_entities < NO_INDEX_MARKER && "Entity capacity too large");
+    assert(max_entities >= last_entity && "Entity capacity smaller than entities already created");
+
+    m_max_entities = max_entities;
+}
+
+EntityStats EntityManager::get_stats() const {
+    EntityStats stats;
+
+    stats.living = count_living_entities();
+    stats.max_entities = m_max_entities;
+    stats.ids_used = last_entity;
+    stats.free_list = destroyed_entities.size();
 
-    return m_dense_signatures[m_sparse_array[entity]];
+    // the query cache is not counted
+    stats.bytes_reserved = m_dense_entities.capacity() * sizeof(Entity) + m_dense_signatures.capacity() * sizeof(Signature)
+        + m_sparse_array.allocated_bytes() + destroyed_entities.size() * sizeof(Entity);
+
+    return stats;
 }
 
 void EntityManager::clear() {
     for(Entity entity : m_dense_entities)
-        m_sparse_array[entity] = NO_SIGNATURE_MARKER;
+        m_sparse_array.reset(entity);
     
     m_dense_entities.clear();
     m_dense_signatures.clear();
+
+    m_query_cache.clear();
+}
+
+// signatures are saved as 64 bit masks of the saving process' component type ids
+static_assert(MAX_COMPONENTS <= 64, "Snapshot signatures do not fit in 64 bits");
+
+void EntityManager::write_snapshot(SnapshotWriter& writer) const {
+    // copied, since a queue can only be read by popping it
+    std::queue<Entity> destroyed = destroyed_entities;
+    std::vector<Entity> destroyed_in_order;
+
+    for(; !destroyed.empty(); destroyed.pop())
+        destroyed_in_order.push_back(destroyed.front());
+
+    std::vector<std::uint64_t> signatures;
+    signatures.reserve(m_dense_signatures.size());
+
+    for(Signature signature : m_dense_signatures)
+        signatures.push_back(signature.to_ullong());
+
+    writer.write(SnapshotEntitiesHeader{count_living_entities(), static_cast<entity_count_size_type>(destroyed_in_order.size()), last_entity, m_max_entities});
+    writer.write_array(m_dense_entities.data(), m_dense_entities.size());
+    writer.write_array(signatures.data(), signatures.size());
+    writer.write_array(destroyed_in_order.data(), destroyed_in_order.size());
+}
+
+// signature in registered component types of a saved signature. false if it has a type which is not in the snapshot
+static bool map_saved_signature(std::uint64_t saved, const snapshot_type_map_type& type_map, Signature& signature) {
+    Signature saved_types {saved};
+
+    for(ComponentType type = 0; type < MAX_COMPONENTS; type++) {
+        if(!saved_types.test(type))
+            continue;
+
+        if(type_map[type] == MAX_COMPONENTS)
+            return false;
+
+        signature.set(type_map[type], true);
+    }
+
+    return true;
+}
+
+bool EntityManager::check_snapshot(SnapshotReader& reader, const snapshot_type_map_type& type_map, SnapshotEntities& entities) const {
+    SnapshotEntitiesHeader header = reader.read<SnapshotEntitiesHeader>();
+
+    // entity ids are below `last_entity`, and each is either living or destroyed
+    if(reader.failed() || header.max_entities == NO_INDEX_MARKER || header.last_entity > header.max_entities
+        || header.living_count > header.last_entity || header.destroyed_count > header.last_entity - header.living_count)
+        return false;
+
+    const Entity* living = reader.read_array<Entity>(header.living_count);
+    const std::uint64_t* signatures = reader.read_array<std::uint64_t>(header.living_count);
+    const Entity* destroyed = reader.read_array<Entity>(header.destroyed_count);
+
+    // the counts fit in the snapshot, so they can be allocated for
+    if(reader.failed())
+        return false;
+
+    std::unordered_set<Entity> used;
+    used.reserve(header.living_count + header.destroyed_count);
+
+    auto use_id = [&](Entity entity) {
+        return entity < header.last_entity && used.insert(entity).second;
+    };
+
+    entities.signatures.reserve(header.living_count);
+
+    for(entity_count_size_type i = 0; i < header.living_count; i++) {
+        Signature signature;
+
+        if(!use_id(living[i]) || !map_saved_signature(signatures[i], type_map, signature))
+            return false;
+
+        entities.signatures.emplace(living[i], signature);
+
+        for(ComponentType type = 0; type < MAX_COMPONENTS; type++)
+            if(signature.test(type))
+                entities.component_counts[type]++;
+    }
+
+    for(entity_count_size_type i = 0; i < header.destroyed_count; i++)
+        if(!use_id(destroyed[i]))
+            return false;
+
+    return true;
+}
+
+void EntityManager::read_snapshot(SnapshotReader& reader, const snapshot_type_map_type& type_map) {
+    clear();
+
+    SnapshotEntitiesHeader header = reader.read<SnapshotEntitiesHeader>();
+
+    const Entity* entities = reader.read_array<Entity>(header.living_count);
+    const std::uint64_t* signatures = reader.read_array<std::uint64_t>(header.living_count);
+    const Entity* destroyed = reader.read_array<Entity>(header.destroyed_count);
+
+    m_max_entities = header.max_entities;
+    last_entity = header.last_entity;
+
+    // destroyed entities are reused in the same order as in the saved scene
+    destroyed_entities = {};
+    for(entity_count_size_type i = 0; i < header.destroyed_count; i++)
+        destroyed_entities.push(destroyed[i]);
+
+    m_dense_entities.assign(entities, entities + header.living_count);
+    m_dense_signatures.resize(header.living_count);
+
+    for(entity_count_size_type i = 0; i < header.living_count; i++) {
+        map_saved_signature(signatures[i], type_map, m_dense_signatures[i]);
+
+        m_sparse_array.set(entities[i], i);
+    }
+
+    m_query_cache.entities_created(m_dense_entities, m_dense_signatures);
 }
\ No newline at end of file
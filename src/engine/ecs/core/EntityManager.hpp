@@ -1,30 +1,65 @@
 #pragma once
 
 #include <queue>
-#include <array>
+#include <span>
 #include <vector>
 
+#include <engine/ecs/core/PagedSparseArray.hpp>
+#include <engine/ecs/core/QueryCache.hpp>
+#include <engine/ecs/core/SceneSnapshot.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
 #include <engine/ecs/core/Types.hpp>
 
 class EntityManager {
 public:
-    EntityManager();
+    EntityManager(entity_count_size_type max_entities = DEFAULT_MAX_ENTITIES);
 
     Entity create_entity();
     void destroy_entity(Entity entity);
 
+    // create `count` entities with the same signature
+    std::vector<Entity> create_entities(entity_count_size_type count, Signature signature);
+
     void set_signature(Entity entity, Signature signature);
-    Signature get_signature(Entity entity);
+    Signature get_signature(Entity entity) const;
+
+    // cached list of the entities matching a signature pair, maintained as signatures change
+    Query& get_query(Signature required, Signature excluded, bool exclusive,
+        const QueryCache::component_entities_type& component_entities);
+
+    // order the queries which require component `type` like `entities` (see QueryCache.hpp)
+    void order_queries(ComponentType type, std::span<const Entity> entities);
+
+    // capacity of entity ids. doubled when all ids are in use and a new one is needed
+    void set_max_entities(entity_count_size_type max_entities);
+    entity_count_size_type get_max_entities() const { return m_max_entities; }
+    entity_count_size_type count_living_entities() const { return m_dense_entities.size(); }
+
+    EntityStats get_stats() const;
 
     void clear();
 
+    // snapshots (see SceneSnapshot.hpp). reading replaces all entities
+    void write_snapshot(SnapshotWriter& writer) const;
+    void read_snapshot(SnapshotReader& reader, const snapshot_type_map_type& type_map);
+
+    // read the entities of a snapshot without loading them. false if they are truncated or inconsistent
+    bool check_snapshot(SnapshotReader& reader, const snapshot_type_map_type& type_map, SnapshotEntities& entities) const;
+
+private:
+    // grow the capacity so that `count` ids past `last_entity` are valid
+    void reserve_new_ids(entity_count_size_type count);
+
 private:
     std::queue<Entity> destroyed_entities;
 
     // sparse set: map from entities to signatures
-    std::array<entity_count_size_type, MAX_ENTITIES> m_sparse_array;
+    PagedSparseArray m_sparse_array;
     std::vector<Entity> m_dense_entities;
     std::vector<Signature> m_dense_signatures;
 
+    QueryCache m_query_cache;
+
+    entity_count_size_type m_max_entities;
     Entity last_entity = 0;
-};
\ No newline at end of file
+};
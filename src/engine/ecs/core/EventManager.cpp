@@ -1,23 +1,108 @@
 #include <engine/ecs/core/EventManager.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
 #include <engine/ecs/core/Event.hpp>
+#include <engine/ecs/core/EventQueue.hpp>
 #include <engine/ecs/core/Types.hpp>
 
+EventManager::EventManager(std::size_t queue_capacity): m_queue{queue_capacity} {}
+
 void EventManager::add_listener(EventId event_id, const std::function<void(Event&)>& listener) {
     m_listeners[event_id].push_back(listener);
 }
 
 void EventManager::send_event(Event& event) {
-    EventId type = event.get_type();
+    auto listeners = m_listeners.find(event.get_type());
+
+    if(listeners == m_listeners.end())
+        return;
 
     // call all listeners for which listen to EventId == `type`
-    for(const auto& listener : m_listeners[type])
+    for(const auto& listener : listeners->second)
         listener(event); // call the listeners with the `Event` as its argument
 }
 
 void EventManager::send_event(EventId event_id) {
+    auto listeners = m_listeners.find(event_id);
+
+    if(listeners == m_listeners.end())
+        return;
+
     Event event {event_id};
 
-    for(const auto& listener : m_listeners[event_id])
+    for(const auto& listener : listeners->second)
         listener(event);
+}
+
+void EventManager::dispatch_queued_events() {
+    auto start = std::chrono::steady_clock::now();
+
+    // drain everything queued so far. events queued by the listeners wait for the next dispatch
+    std::size_t drained = 0;
+
+    auto add_to_batch = [this](const EventQueue::Record& record) {
+        // events without listeners are dropped
+        if(record.type >= m_typed_listeners.size() || !m_typed_listeners[record.type])
+            return;
+
+        if(record.type >= m_batches.size())
+            m_batches.resize(record.type + 1);
+
+        if(m_batches[record.type].empty())
+            m_batch_types.push_back(record.type);
+
+        m_batches[record.type].push_back(record);
+    };
+
+    EventQueue::Record record;
+
+    while(m_queue.try_pop(record)) {
+        add_to_batch(record);
+        drained++;
+    }
+
+    {
+        std::lock_guard lock{m_overflow_mutex};
+
+        // a thread's events in the ring buffer were claimed before its overflowed events were added,
+        // drain all claimed positions so that they are dispatched first
+        std::size_t end = m_queue.tail();
+
+        while(m_queue.pop_before(end, record)) {
+            add_to_batch(record);
+            drained++;
+        }
+
+        for(const EventQueue::Record& overflow_record : m_overflow)
+            add_to_batch(overflow_record);
+
+        drained += m_overflow.size();
+        m_overflow.clear();
+        m_overflowing.store(false, std::memory_order_release);
+    }
+
+    for(std::size_t type : m_batch_types) {
+        m_typed_listeners[type]->dispatch_batch(m_batches[type]);
+        m_batches[type].clear();
+    }
+
+    m_batch_types.clear();
+
+    // stats
+    m_dispatched_events = drained;
+    m_max_queue_depth = std::max(m_max_queue_depth, drained);
+    m_dispatch_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+EventQueueStats EventManager::get_queue_stats() const {
+    return {
+        .queue_depth = m_queue.size(),
+        .max_queue_depth = m_max_queue_depth,
+        .dispatched_events = m_dispatched_events,
+        .overflowed_events = m_overflowed_events.load(std::memory_order_relaxed),
+        .dispatch_time_ms = m_dispatch_time_ms
+    };
 }
\ No newline at end of file
@@ -1,18 +1,214 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
 #include <vector>
 #include <unordered_map>
 
+#include <lib/utilities/TypeId.hpp>
+
 #include <engine/ecs/core/Event.hpp>
+#include <engine/ecs/core/EventQueue.hpp>
 #include <engine/ecs/core/Types.hpp>
 
+// Typed events are plain structs, sent by value and identified by a static id of their type:
+//      struct MouseMoved { double x_offset; double y_offset; };
+//      scene.add_event_listener<&CameraControlSystem::mouse_moved>(this);
+//      scene.send_event(MouseMoved{x_offset, y_offset});
+// Listeners are called through a function pointer, without allocating an `Event` or a std::function.
+// `Event` and its `EventId`s (see Events.hpp) remain supported alongside typed events.
+//
+// `send_event` calls the listeners immediately. `queue_event` can be called from any thread: the
+// event is pushed to a lock-free ring buffer, and `dispatch_queued_events` (called on the thread
+// owning the listeners) drains it and calls the listeners of each event type with all of its
+// queued events in a batch. Event types are dispatched in order of their first queued event, and
+// events of the same type in the order they were queued.
+struct EventFamily {};
+
+template<typename T>
+std::size_t event_type_id() {
+    return FamilyTypeId<EventFamily>::get<std::remove_cvref_t<T>>();
+}
+
+template<typename T>
+concept TypedEvent = std::is_class_v<T> && !std::is_same_v<T, Event>;
+
+struct EventQueueStats {
+    std::size_t queue_depth;        // events waiting for the next dispatch
+    std::size_t max_queue_depth;    // most events drained by one dispatch
+    std::size_t dispatched_events;  // events drained by the last dispatch
+    std::size_t overflowed_events;  // events queued while the ring buffer was full, in total
+    double dispatch_time_ms;        // duration of the last dispatch
+};
+
 class EventManager {
 public:
+    EventManager(std::size_t queue_capacity = EVENT_QUEUE_CAPACITY);
+
     void add_listener(EventId event_id, const std::function<void(Event&)>& listener);
     void send_event(Event& event);
     void send_event(EventId event_id);
 
+    // typed events
+    template<TypedEvent T>
+    void add_listener(void (*listener)(const T&));
+
+    // `Method` is a member function `void Class::method(const T&)` called on `instance`
+    template<auto Method, typename Class>
+    void add_listener(Class* instance);
+
+    template<TypedEvent T>
+    void send_event(const T& event);
+
+    // queued typed events
+    template<TypedEvent T>
+    void queue_event(const T& event); // thread safe
+
+    void dispatch_queued_events();
+    EventQueueStats get_queue_stats() const;
+
+private:
+    template<typename T>
+    struct TypedListener {
+        void (*function)(const T&); // free function listener
+        void (*method)(void* instance, const T&); // calls the member function listener on `instance`
+        void* instance;
+    };
+
+    class ITypedListeners {
+    public:
+        virtual ~ITypedListeners() = default;
+        virtual void dispatch_batch(const std::vector<EventQueue::Record>& records) const = 0;
+    };
+
+    template<typename T>
+    class TypedListeners : public ITypedListeners {
+    public:
+        void dispatch(const T& event) const;
+        void dispatch_batch(const std::vector<EventQueue::Record>& records) const;
+
+        std::vector<TypedListener<T>> listeners;
+    };
+
+    template<typename T>
+    TypedListeners<T>& get_typed_listeners();
+
+    // event type of a member function listener
+    template<typename Method>
+    struct method_event;
+
+    template<typename Class, typename T>
+    struct method_event<void (Class::*)(const T&)> { using type = T; };
+
 private:
     std::unordered_map<EventId, std::vector<std::function<void(Event&)>>> m_listeners;
-};
\ No newline at end of file
+
+    std::vector<std::unique_ptr<ITypedListeners>> m_typed_listeners; // indexed by `event_type_id`
+
+    EventQueue m_queue;
+
+    // events queued while the ring buffer is full
+    std::mutex m_overflow_mutex;
+    std::vector<EventQueue::Record> m_overflow;
+    std::atomic<bool> m_overflowing = false;
+
+    // queued events of each type for the current dispatch, kept allocated between dispatches
+    std::vector<std::vector<EventQueue::Record>> m_batches; // indexed by `event_type_id`
+    std::vector<std::size_t> m_batch_types; // in order of their first event
+
+    // stats
+    std::atomic<std::size_t> m_overflowed_events = 0;
+    std::size_t m_max_queue_depth = 0;
+    std::size_t m_dispatched_events = 0;
+    double m_dispatch_time_ms = 0;
+};
+
+template<TypedEvent T>
+void EventManager::add_listener(void (*listener)(const T&)) {
+    get_typed_listeners<T>().listeners.push_back({.function = listener, .method = nullptr, .instance = nullptr});
+}
+
+template<auto Method, typename Class>
+void EventManager::add_listener(Class* instance) {
+    using event_type = typename method_event<decltype(Method)>::type;
+
+    auto call_method = [](void* instance, const event_type& event) {
+        (static_cast<Class*>(instance)->*Method)(event);
+    };
+
+    get_typed_listeners<event_type>().listeners.push_back({.function = nullptr, .method = call_method, .instance = instance});
+}
+
+template<TypedEvent T>
+void EventManager::send_event(const T& event) {
+    std::size_t type = event_type_id<T>();
+
+    // no listener has been added for this event type
+    if(type >= m_typed_listeners.size() || !m_typed_listeners[type])
+        return;
+
+    static_cast<TypedListeners<T>*>(m_typed_listeners[type].get())->dispatch(event);
+}
+
+template<TypedEvent T>
+void EventManager::queue_event(const T& event) {
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= EventQueue::PAYLOAD_SIZE && alignof(T) <= alignof(std::max_align_t),
+        "Queued events must be trivially copyable and fit in EventQueue::PAYLOAD_SIZE");
+
+    EventQueue::Record record;
+    record.type = event_type_id<T>();
+    new (record.payload) T(event);
+
+    // once an event has overflowed, the next ones go to the overflow too until it is drained, so
+    // that the events of a thread are dispatched in order
+    if(!m_overflowing.load(std::memory_order_acquire) && m_queue.try_push(record))
+        return;
+
+    std::lock_guard lock{m_overflow_mutex};
+    m_overflow.push_back(record);
+    m_overflowing.store(true, std::memory_order_release);
+    m_overflowed_events.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename T>
+void EventManager::TypedListeners<T>::dispatch(const T& event) const {
+    for(const TypedListener<T>& listener : listeners) {
+        if(listener.function)
+            listener.function(event);
+        else
+            listener.method(listener.instance, event);
+    }
+}
+
+template<typename T>
+void EventManager::TypedListeners<T>::dispatch_batch(const std::vector<EventQueue::Record>& records) const {
+    // each listener handles the whole batch in turn
+    for(const TypedListener<T>& listener : listeners) {
+        for(const EventQueue::Record& record : records) {
+            const T& event = *std::launder(reinterpret_cast<const T*>(record.payload));
+
+            if(listener.function)
+                listener.function(event);
+            else
+                listener.method(listener.instance, event);
+        }
+    }
+}
+
+template<typename T>
+EventManager::TypedListeners<T>& EventManager::get_typed_listeners() {
+    std::size_t type = event_type_id<T>();
+
+    if(type >= m_typed_listeners.size())
+        m_typed_listeners.resize(type + 1);
+
+    if(!m_typed_listeners[type])
+        m_typed_listeners[type] = std::make_unique<TypedListeners<T>>();
+
+    return *static_cast<TypedListeners<T>*>(m_typed_listeners[type].get());
+}
\ No newline at end of file
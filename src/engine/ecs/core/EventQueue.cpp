@@ -0,0 +1,79 @@
+#include <engine/ecs/core/EventQueue.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <thread>
+
+EventQueue::EventQueue(std::size_t capacity) {
+    capacity = std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity);
+
+    m_slots = std::make_unique<Slot[]>(capacity);
+    m_mask = capacity - 1;
+
+    // slot i is free for the producer at position i
+    for(std::size_t i = 0; i < capacity; i++)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool EventQueue::try_push(const Record& record) {
+    std::size_t position = m_tail.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    for(;;) {
+        slot = &m_slots[position & m_mask];
+
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+        if(difference == 0) {
+            // claim the slot
+            if(m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if(difference < 0) {
+            // the slot still holds the record from one lap ago
+            return false;
+        } else {
+            // another producer claimed the position
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = record;
+    slot->sequence.store(position + 1, std::memory_order_release); // publish to the consumer
+
+    return true;
+}
+
+bool EventQueue::try_pop(Record& record) {
+    std::size_t position = m_head.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[position & m_mask];
+
+    // empty, or the producer of this position has not finished writing
+    if(slot.sequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+
+    record = slot.record;
+    slot.sequence.store(position + m_mask + 1, std::memory_order_release); // free for the next lap
+
+    m_head.store(position + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool EventQueue::pop_before(std::size_t end, Record& record) {
+    if(m_head.load(std::memory_order_relaxed) == end)
+        return false;
+
+    // the position is claimed, its producer is between claiming and publishing
+    while(!try_pop(record))
+        std::this_thread::yield();
+
+    return true;
+}
+
+std::size_t EventQueue::size() const {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    return tail > head ? tail - head : 0;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// EventQueue
+// Bounded lock-free ring buffer of typed event records, with any number of producer
+// threads and a single consumer thread. Every slot carries a sequence number telling
+// whether it is free for the producer at a position or holds a record for the consumer.
+class EventQueue {
+public:
+    // queued events are trivially copyable structs of at most this size
+    static constexpr std::size_t PAYLOAD_SIZE = 48;
+
+    struct Record {
+        std::size_t type; // `event_type_id` of the event
+        alignas(std::max_align_t) std::byte payload[PAYLOAD_SIZE];
+    };
+
+    // `capacity` is rounded up to a power of two
+    EventQueue(std::size_t capacity);
+
+    // returns false if the queue is full
+    bool try_push(const Record& record);
+
+    // consumer only. returns false if the queue is empty
+    bool try_pop(Record& record);
+
+    // consumer only. pops the next record if its position is before `end`, waiting for its producer
+    // to finish writing it. with `end = tail()` this drains every record claimed so far
+    bool pop_before(std::size_t end, Record& record);
+    std::size_t tail() const { return m_tail.load(std::memory_order_acquire); }
+
+    // approximate when producers are pushing concurrently
+    std::size_t size() const;
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        Record record;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_mask;
+
+    // producers and consumer on separate cache lines
+    alignas(64) std::atomic<std::size_t> m_tail = 0;
+    alignas(64) std::atomic<std::size_t> m_head = 0;
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneView.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// Group
+// Owning group of a fixed set of component types, for the hottest queries:
+//      Group<A, B>(scene).each([](Entity entity, A& a, B& b) { ... });
+//
+// The group is declared on the scene the first time it is constructed and is then
+// maintained by the scene as components are added and removed (see `OwningGroup`).
+// Its entities are packed at the front of each owned component array in the same order,
+// so iterating it is a linear walk over the component arrays without sparse lookups.
+// As with `SceneView`, components of non-const types are marked as changed by `each`, and recorded
+// for their `on_changed` observers.
+// Tag types have no arrays: they only decide which entities are in the group.
+//
+// With ECS_ARCHETYPE_STORAGE entities are already packed by signature, and a group
+// is a `SceneView` of its component types.
+//
+// Entities and components must not be created or removed while a group is being iterated.
+
+template<typename ...ComponentTypes>
+class Group {
+public:
+    Group(Scene& scene);
+
+    // call `func(Entity, ComponentTypes&...)` for every entity in the group
+    template<typename Func>
+    void each(Func&& func) const;
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    entity_count_size_type size() const; // counts the entities of the view
+
+    auto begin() const { return m_view.begin(); }
+    auto end() const { return m_view.end(); }
+
+private:
+    SceneView<ComponentTypes...> m_view;
+#else
+    entity_count_size_type size() const { return m_group->size(); }
+
+    vector_entity_iterator begin() const { return first_array()->begin(); }
+    vector_entity_iterator end() const { return first_array()->begin() + m_group->size(); }
+
+private:
+    // index of the first type which is not a tag, its array lists the entities of the group
+    static constexpr std::size_t FIRST_ARRAY = [] {
+        constexpr bool tags[] {is_tag_component_v<ComponentTypes>...};
+
+        std::size_t i = 0;
+        while(i < sizeof...(ComponentTypes) && tags[i])
+            i++;
+
+        return i;
+    }();
+
+    static_assert(FIRST_ARRAY < sizeof...(ComponentTypes), "Group must own a component type which is not a tag");
+
+    auto first_array() const { return std::get<FIRST_ARRAY>(m_component_arrays); }
+
+    template<typename T>
+    component_reference_t<T> get_data_at(entity_count_size_type index) const;
+
+    OwningGroup* m_group;
+    ComponentObservers* m_observers;
+    std::tuple<ComponentArray<std::remove_const_t<ComponentTypes>>*...> m_component_arrays; // nullptr for tags
+#endif
+};
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+template<typename ...ComponentTypes>
+Group<ComponentTypes...>::Group(Scene& scene): m_view{scene} {}
+
+template<typename ...ComponentTypes>
+entity_count_size_type Group<ComponentTypes...>::size() const {
+    entity_count_size_type count = 0;
+
+    for(auto it = begin(); it != end(); ++it)
+        count++;
+
+    return count;
+}
+
+template<typename ...ComponentTypes>
+template<typename Func>
+void Group<ComponentTypes...>::each(Func&& func) const {
+    m_view.each(std::forward<Func>(func));
+}
+#else
+template<typename ...ComponentTypes>
+Group<ComponentTypes...>::Group(Scene& scene):
+    m_group{&scene.get_owning_group<ComponentTypes...>()},
+    m_observers{&scene.get_observers()},
+    m_component_arrays{scene.get_component_array<ComponentTypes>()...} {}
+
+template<typename ...ComponentTypes>
+template<typename Func>
+void Group<ComponentTypes...>::each(Func&& func) const {
+    vector_entity_iterator entities = first_array()->begin();
+    entity_count_size_type size = m_group->size();
+
+    for(entity_count_size_type i = 0; i < size; i++) {
+        func(entities[i], get_data_at<ComponentTypes>(i)...);
+
+        // components passed by non-const reference may have been written
+        ((std::is_const_v<ComponentTypes> || is_tag_component_v<ComponentTypes> || (std::get<ComponentArray<std::remove_const_t<ComponentTypes>>*>(m_component_arrays)->mark_changed_at(i), true)), ...);
+    }
+
+    // the group's entities are contiguous, so the changes are recorded from the array directly
+    Signature observed = m_observers->get_observed(ComponentObservers::COMPONENT_CHANGED) & written_components_signature<ComponentTypes...>();
+
+    if(observed.any() && size > 0)
+        m_observers->record(ComponentObservers::COMPONENT_CHANGED, observed, &*entities, size);
+}
+
+template<typename ...ComponentTypes>
+template<typename T>
+component_reference_t<T> Group<ComponentTypes...>::get_data_at(entity_count_size_type index) const {
+    if constexpr(is_tag_component_v<T>)
+        return tag_component<T>();
+    else
+        return std::get<ComponentArray<std::remove_const_t<T>>*>(m_component_arrays)->get_data_at(index);
+}
+#endif
@@ -0,0 +1,69 @@
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/OwningGroup.hpp>
+
+#include <engine/ecs/core/EntityManager.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+OwningGroup::OwningGroup(Signature owned, std::vector<IComponentArray*> component_arrays, Signature tags, const EntityManager& entity_manager):
+    m_owned{owned}, m_component_arrays{std::move(component_arrays)}, m_tags{tags}, m_entity_manager{&entity_manager} {
+    assert(!m_component_arrays.empty() && "Group must own a component type which is not a tag");
+
+    rebuild();
+}
+
+void OwningGroup::rebuild() {
+    m_size = 0;
+
+    // pack the entities which already have all owned components
+    // (copied, since adding entities to the group reorders the array)
+    std::vector<Entity> entities(m_component_arrays[0]->begin(), m_component_arrays[0]->end());
+
+    for(Entity entity : entities)
+        entity_added(entity);
+}
+
+void OwningGroup::entity_added(Entity entity) {
+    if(contains(entity))
+        return;
+
+    for(IComponentArray* component_array : m_component_arrays)
+        if(!component_array->has_component(entity))
+            return;
+
+    if(m_tags.any() && (m_entity_manager->get_signature(entity) & m_tags) != m_tags)
+        return;
+
+    // move the entity to the end of the packed range
+    for(IComponentArray* component_array : m_component_arrays)
+        component_array->swap_indices(component_array->get_index(entity), m_size);
+
+    m_size++;
+}
+
+void OwningGroup::entity_removed(Entity entity) {
+    if(!contains(entity))
+        return;
+
+    m_size--;
+
+    // move the entity out of the packed range, the last entity of the range takes its place
+    for(IComponentArray* component_array : m_component_arrays)
+        component_array->swap_indices(component_array->get_index(entity), m_size);
+}
+
+bool OwningGroup::contains(Entity entity) const {
+    entity_count_size_type index = m_component_arrays[0]->get_index(entity);
+
+    return index != NO_INDEX_MARKER && index < m_size;
+}
+
+
+void OwningGroup::apply_order(const std::vector<entity_count_size_type>& order) {
+    assert(order.size() == m_size && "Order does not cover the group");
+
+    for(IComponentArray* component_array : m_component_arrays)
+        component_array->apply_order(order);
+}
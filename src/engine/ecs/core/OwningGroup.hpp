@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include <engine/ecs/core/ComponentArray.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+class EntityManager;
+
+// Bookkeeping of an owning group (sparse set storage only)
+// A group owns the component arrays of its component types and keeps the entities which
+// have all of them packed at the front of every owned array, in the same order.
+// So index `i < size()` of each owned array belongs to the same entity, and the group can
+// be iterated without any sparse lookups.
+//
+// A component type can be owned by at most one group.
+// Tag component types of the group have no arrays. An entity must have them in its signature to
+// be in the group, so a tag must be added to the entity's signature before the group is notified.
+class OwningGroup {
+public:
+    OwningGroup(Signature owned, std::vector<IComponentArray*> component_arrays, Signature tags, const EntityManager& entity_manager);
+
+    // call after a component owned by the group has been added to `entity`
+    void entity_added(Entity entity);
+
+    // call before a component owned by the group is removed from `entity`
+    void entity_removed(Entity entity);
+
+    bool contains(Entity entity) const;
+
+    // pack the entities which have all owned components again, after the owned arrays were replaced
+    void rebuild();
+
+    // reorder the packed range of every owned array (see `IComponentArray::apply_order`)
+    void apply_order(const std::vector<entity_count_size_type>& order);
+
+    Signature get_signature() const { return m_owned; }
+    entity_count_size_type size() const { return m_size; }
+
+private:
+    Signature m_owned;
+    std::vector<IComponentArray*> m_component_arrays; // arrays of the owned types which are not tags
+
+    Signature m_tags;
+    const EntityManager* const m_entity_manager;
+
+    entity_count_size_type m_size = 0; // entities of the group occupy [0, m_size) of every owned array
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cassert>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <engine/ecs/core/Types.hpp>
+
+// Sparse half of a sparse set: maps an `Entity` to an index into a dense array.
+// The entity range is split into fixed size pages which are only allocated once an
+// entity inside them is written, so memory grows with the entity ids actually in use
+// instead of with the entity capacity of the scene.
+class PagedSparseArray {
+public:
+    static constexpr entity_count_size_type PAGE_SIZE = 4096; // entries per page (16 KB)
+
+    entity_count_size_type get(Entity entity) const;
+    void set(Entity entity, entity_count_size_type index);
+    void reset(Entity entity);
+
+    bool contains(Entity entity) const { return get(entity) != NO_INDEX_MARKER; }
+
+    std::size_t allocated_pages() const;
+    std::size_t allocated_bytes() const; // pages and page table
+
+    // release all pages
+    void clear() { m_pages.clear(); }
+
+private:
+    using page_type = std::array<entity_count_size_type, PAGE_SIZE>;
+
+    static constexpr std::size_t page_of(Entity entity) { return entity / PAGE_SIZE; }
+    static constexpr std::size_t offset_of(Entity entity) { return entity % PAGE_SIZE; }
+
+    std::vector<std::unique_ptr<page_type>> m_pages;
+};
+
+inline entity_count_size_type PagedSparseArray::get(Entity entity) const {
+    std::size_t page = page_of(entity);
+
+    if(page >= m_pages.size() || !m_pages[page])
+        return NO_INDEX_MARKER;
+
+    return (*m_pages[page])[offset_of(entity)];
+}
+
+inline void PagedSparseArray::set(Entity entity, entity_count_size_type index) {
+    std::size_t page = page_of(entity);
+
+    if(page >= m_pages.size())
+        m_pages.resize(page + 1);
+
+    // lazily allocate the page on first write
+    if(!m_pages[page]) {
+        m_pages[page] = std::make_unique<page_type>();
+        m_pages[page]->fill(NO_INDEX_MARKER);
+    }
+
+    (*m_pages[page])[offset_of(entity)] = index;
+}
+
+inline void PagedSparseArray::reset(Entity entity) {
+    std::size_t page = page_of(entity);
+
+    // an entity without a page was never set, nothing to reset
+    if(page < m_pages.size() && m_pages[page])
+        (*m_pages[page])[offset_of(entity)] = NO_INDEX_MARKER;
+}
+
+inline std::size_t PagedSparseArray::allocated_pages() const {
+    std::size_t count = 0;
+
+    for(const auto& page : m_pages)
+        if(page)
+            count++;
+
+    return count;
+}
+
+inline std::size_t PagedSparseArray::allocated_bytes() const {
+    return allocated_pages() * sizeof(page_type) + m_pages.capacity() * sizeof(m_pages[0]);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/ComponentManager.hpp>
+#include <engine/ecs/core/ComponentTypeId.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// Prefab
+// A set of component values to instantiate entities from:
+//      Prefab prop {Components::Transform{...}, Components::Model{...}, Components::Renderable{}};
+//      std::vector<Entity> props = scene.create_entities(10000, prop);
+// Every entity created from a prefab gets a copy of each of its components.
+class Prefab {
+public:
+    Prefab() = default;
+
+    template<typename ...ComponentTypes>
+    Prefab(ComponentTypes ...components);
+
+    // add the component to the prefab, or replace the prefab's component of the same type
+    template<typename T>
+    void set_component(T component);
+
+    template<typename T>
+    T& get_component();
+
+    Signature get_signature() const { return m_signature; }
+
+    // add the prefab's components to entities which have none of them
+    void instantiate(ComponentManager& component_manager, const Entity* entities, entity_count_size_type count) const;
+
+private:
+    class IPrefabComponent {
+    public:
+        virtual ~IPrefabComponent() = default;
+        virtual void instantiate(ComponentManager& component_manager, const Entity* entities, entity_count_size_type count) const = 0;
+    };
+
+    template<typename T>
+    class PrefabComponent : public IPrefabComponent {
+    public:
+        PrefabComponent(T component): component{std::move(component)} {}
+
+        void instantiate(ComponentManager& component_manager, const Entity* entities, entity_count_size_type count) const {
+            component_manager.add_components<T>(entities, count, component);
+        }
+
+        T component;
+    };
+
+    template<typename T>
+    PrefabComponent<T>* find_component();
+
+private:
+    Signature m_signature;
+    std::vector<std::unique_ptr<IPrefabComponent>> m_components;
+    std::vector<ComponentType> m_component_types; // type of each component in `m_components`
+};
+
+template<typename ...ComponentTypes>
+Prefab::Prefab(ComponentTypes ...components) {
+    (set_component(std::move(components)), ...);
+}
+
+template<typename T>
+void Prefab::set_component(T component) {
+    if(PrefabComponent<T>* prefab_component = find_component<T>()) {
+        prefab_component->component = std::move(component);
+        return;
+    }
+
+    m_signature.set(component_type_id<T>(), true);
+    m_components.push_back(std::make_unique<PrefabComponent<T>>(std::move(component)));
+    m_component_types.push_back(component_type_id<T>());
+}
+
+template<typename T>
+T& Prefab::get_component() {
+    PrefabComponent<T>* prefab_component = find_component<T>();
+
+    assert(prefab_component && "Component does not exist in prefab");
+
+    return prefab_component->component;
+}
+
+template<typename T>
+Prefab::PrefabComponent<T>* Prefab::find_component() {
+    for(std::size_t i = 0; i < m_components.size(); i++)
+        if(m_component_types[i] == component_type_id<T>())
+            return static_cast<PrefabComponent<T>*>(m_components[i].get());
+
+    return nullptr;
+}
+
+inline void Prefab::instantiate(ComponentManager& component_manager, const Entity* entities, entity_count_size_type count) const {
+    for(const auto& prefab_component : m_components)
+        prefab_component->instantiate(component_manager, entities, count);
+}
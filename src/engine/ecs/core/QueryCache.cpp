@@ -0,0 +1,162 @@
+#include <engine/ecs/core/QueryCache.hpp>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/Types.hpp>
+
+// Query
+
+Query::Query(Signature required, Signature excluded, bool exclusive):
+    m_required{required}, m_excluded{excluded}, m_exclusive{exclusive} {}
+
+bool Query::matches(Signature signature) const {
+    if(m_exclusive)
+        return signature == m_required;
+
+    return (signature & m_required) == m_required && (signature & m_excluded).none();
+}
+
+bool Query::has_key(Signature required, Signature excluded, bool exclusive) const {
+    return m_required == required && m_excluded == excluded && m_exclusive == exclusive;
+}
+
+void Query::add(Entity entity) {
+    assert(!contains(entity) && "Entity added to query more than once");
+
+    m_indices.set(entity, m_entities.size());
+    m_entities.push_back(entity);
+}
+
+void Query::remove(Entity entity) {
+    entity_count_size_type index = m_indices.get(entity);
+
+    assert(index != NO_INDEX_MARKER && "Entity not in query");
+
+    Entity last = m_entities.back();
+
+    m_entities[index] = last;
+    m_indices.set(last, index);
+
+    m_entities.pop_back();
+    m_indices.reset(entity);
+}
+
+void Query::order_like(std::span<const Entity> entities) {
+    entity_count_size_type next = 0;
+
+    for(Entity entity : entities) {
+        if(!contains(entity))
+            continue;
+
+        entity_count_size_type index = m_indices.get(entity);
+        Entity displaced = m_entities[next];
+
+        std::swap(m_entities[next], m_entities[index]);
+        m_indices.set(displaced, index);
+        m_indices.set(entity, next++);
+    }
+}
+
+void Query::clear() {
+    for(Entity entity : m_entities)
+        m_indices.reset(entity);
+
+    m_entities.clear();
+}
+
+// QueryCache
+
+Query& QueryCache::get_query(Signature required, Signature excluded, bool exclusive,
+    const std::vector<Entity>& entities, const std::vector<Signature>& signatures,
+    const component_entities_type& component_entities) {
+    std::lock_guard lock{m_mutex};
+
+    for(const auto& query : m_queries)
+        if(query->has_key(required, excluded, exclusive))
+            return *query;
+
+    Query& query = *m_queries.emplace_back(std::make_unique<Query>(required, excluded, exclusive));
+
+    for(std::size_t i = 0; i < entities.size(); i++)
+        if(query.matches(signatures[i]))
+            query.add(entities[i]);
+
+    // follow the component type sorted last among the required ones
+    for(auto type = m_sorted_types.rbegin(); type != m_sorted_types.rend(); type++) {
+        if(required.test(*type)) {
+            query.order_like(component_entities(*type));
+            break;
+        }
+    }
+
+    return query;
+}
+
+void QueryCache::entities_created(const Entity* entities, entity_count_size_type count, Signature signature) {
+    std::lock_guard lock{m_mutex};
+
+    for(const auto& query : m_queries)
+        if(query->matches(signature))
+            for(entity_count_size_type i = 0; i < count; i++)
+                query->add(entities[i]);
+}
+
+void QueryCache::entities_created(const std::vector<Entity>& entities, const std::vector<Signature>& signatures) {
+    std::lock_guard lock{m_mutex};
+
+    for(const auto& query : m_queries)
+        for(std::size_t i = 0; i < entities.size(); i++)
+            if(query->matches(signatures[i]))
+                query->add(entities[i]);
+}
+
+void QueryCache::signature_changed(Entity entity, Signature old_signature, Signature signature) {
+    if(old_signature == signature)
+        return;
+
+    std::lock_guard lock{m_mutex};
+
+    // the queries hold the entity as matched by its old signature, so only the queries whose
+    // match changes are touched. this is a few bit operations for queries which do not use the
+    // changed components
+    for(const auto& query : m_queries) {
+        bool matched = query->matches(old_signature);
+
+        if(matched != query->matches(signature)) {
+            if(matched)
+                query->remove(entity);
+            else
+                query->add(entity);
+        }
+    }
+}
+
+void QueryCache::entity_destroyed(Entity entity, Signature signature) {
+    std::lock_guard lock{m_mutex};
+
+    for(const auto& query : m_queries)
+        if(query->matches(signature))
+            query->remove(entity);
+}
+
+void QueryCache::order_queries(ComponentType type, std::span<const Entity> entities) {
+    std::lock_guard lock{m_mutex};
+
+    for(const auto& query : m_queries)
+        if(query->get_required().test(type))
+            query->order_like(entities);
+
+    std::erase(m_sorted_types, type);
+    m_sorted_types.push_back(type);
+}
+
+void QueryCache::clear() {
+    std::lock_guard lock{m_mutex};
+
+    for(const auto& query : m_queries)
+        query->clear();
+
+    m_sorted_types.clear();
+}
\ No newline at end of file
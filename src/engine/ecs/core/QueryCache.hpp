@@ -0,0 +1,81 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include <engine/ecs/core/PagedSparseArray.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// Query
+// Dense list of the entities matching a signature pair: entities which have all of the
+// required components and none of the excluded ones (or exactly the required ones, for an
+// exclusive query). Kept up to date by `QueryCache` as entity signatures change.
+class Query {
+public:
+    Query(Signature required, Signature excluded, bool exclusive);
+
+    bool matches(Signature signature) const;
+    bool has_key(Signature required, Signature excluded, bool exclusive) const;
+
+    bool contains(Entity entity) const { return m_indices.contains(entity); }
+    void add(Entity entity);
+    void remove(Entity entity); // swap remove, the order of the entities is not kept
+    void clear();
+
+    // move the entities of the query which are in `entities` to the front, in that order
+    void order_like(std::span<const Entity> entities);
+
+    Signature get_required() const { return m_required; }
+
+    std::vector<Entity>::iterator begin() { return m_entities.begin(); }
+    std::vector<Entity>::iterator end() { return m_entities.end(); }
+    entity_count_size_type size() const { return m_entities.size(); }
+
+private:
+    Signature m_required;
+    Signature m_excluded;
+    bool m_exclusive;
+
+    // `Entity` to index in `m_entities` sparse set
+    PagedSparseArray m_indices;
+    std::vector<Entity> m_entities;
+};
+
+// QueryCache
+// Queries are created on first use, filled from the living entities, and then maintained
+// incrementally for the lifetime of the cache. Views get the same query for the same
+// signature pair, so matching entities are never searched for again.
+class QueryCache {
+public:
+    // entities of the component array of a type, in the order they are stored
+    using component_entities_type = std::function<std::span<const Entity>(ComponentType)>;
+
+    // `entities` and `signatures` are the living entities, used to fill a new query. a new query which
+    // requires a sorted component type is ordered like `component_entities(type)`
+    Query& get_query(Signature required, Signature excluded, bool exclusive,
+        const std::vector<Entity>& entities, const std::vector<Signature>& signatures,
+        const component_entities_type& component_entities);
+
+    // add new entities to the queries they match
+    void entities_created(const Entity* entities, entity_count_size_type count, Signature signature);
+    void entities_created(const std::vector<Entity>& entities, const std::vector<Signature>& signatures);
+
+    // add or remove the entity from the queries it starts or stops matching
+    void signature_changed(Entity entity, Signature old_signature, Signature signature);
+    void entity_destroyed(Entity entity, Signature signature);
+
+    // order the queries which require component `type` like `entities`. queries created later are
+    // ordered like the components of `type` (see `Scene::sort`). the order holds until entities join
+    // or leave a query
+    void order_queries(ComponentType type, std::span<const Entity> entities);
+
+    void clear(); // empties the queries, which stay cached
+
+private:
+    std::mutex m_mutex; // views may be constructed from several threads
+    std::vector<std::unique_ptr<Query>> m_queries;
+    std::vector<ComponentType> m_sorted_types; // the last sorted last
+};
\ No newline at end of file
@@ -1,26 +1,112 @@
 #include <memory>
 #include <functional>
+#include <vector>
 
 #include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneCommandBuffer.hpp>
 
 #include <engine/ecs/core/Types.hpp>
 #include <engine/ecs/core/Event.hpp>
 
 // Entity Methods
-Scene::Scene() {
-    m_component_manager = std::make_unique<ComponentManager>();
-    m_entity_manager = std::make_unique<EntityManager>();
+Scene::Scene(entity_count_size_type max_entities) {
+    m_entity_manager = std::make_unique<EntityManager>(max_entities);
+    m_component_manager = std::make_unique<ComponentManager>(*m_entity_manager);
     m_event_manager = std::make_unique<EventManager>();
     m_system_manager = std::make_unique<SystemManager>();
+    m_observers = std::make_unique<ComponentObservers>();
+
+    m_command_buffers.push_back(std::make_unique<SceneCommandBuffer>());
 }
 
+Scene::~Scene() = default;
+
 Entity Scene::create_entity() {
     return m_entity_manager->create_entity();
 }
 
+std::vector<Entity> Scene::create_entities(entity_count_size_type count, const Prefab& prefab) {
+    std::vector<Entity> entities = m_entity_manager->create_entities(count, prefab.get_signature());
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_component_manager->add_entities(entities.data(), count, prefab.get_signature());
+#endif
+
+    prefab.instantiate(*m_component_manager, entities.data(), count);
+
+    m_observers->record(ComponentObservers::COMPONENT_ADDED, prefab.get_signature(), entities.data(), count);
+
+    return entities;
+}
+
 void Scene::destroy_entity(Entity entity) {
+    m_observers->record(ComponentObservers::COMPONENT_REMOVED, m_entity_manager->get_signature(entity), &entity, 1);
+    m_component_manager->entity_destroyed(entity); // reads the signature of the entity
     m_entity_manager->destroy_entity(entity);
-    m_component_manager->entity_destroyed(entity);
+}
+
+void Scene::set_max_entities(entity_count_size_type max_entities) {
+    m_entity_manager->set_max_entities(max_entities);
+}
+
+entity_count_size_type Scene::get_max_entities() const {
+    return m_entity_manager->get_max_entities();
+}
+
+// System Methods
+void Scene::update(float dt) {
+    dispatch_queued_events();
+
+    m_system_manager->update(dt, get_thread_pool());
+
+    flush_commands();
+    flush_observers();
+}
+
+// Command Buffer Methods
+SceneCommandBuffer& Scene::get_command_buffer() {
+    // without a thread pool there is only the buffer of outside threads
+    unsigned int index = m_thread_pool ? m_thread_pool->current_worker() : 0;
+
+    return *m_command_buffers[index];
+}
+
+void Scene::flush_commands() {
+    for(auto& command_buffer : m_command_buffers)
+        command_buffer->playback(*this);
+}
+
+void Scene::create_command_buffers() {
+    std::unique_ptr<SceneCommandBuffer> outside = std::move(m_command_buffers.back());
+    m_command_buffers.clear();
+
+    for(unsigned int i = 0; i < m_thread_pool->count_workers(); i++)
+        m_command_buffers.push_back(std::make_unique<SceneCommandBuffer>());
+
+    m_command_buffers.push_back(std::move(outside));
+}
+
+// Observer Methods
+void Scene::flush_observers() {
+    m_observers->flush();
+}
+
+// Thread Methods
+ThreadPool& Scene::get_thread_pool() {
+    if(!m_thread_pool) {
+        m_thread_pool = std::make_unique<ThreadPool>();
+        create_command_buffers();
+    }
+
+    return *m_thread_pool;
+}
+
+void Scene::set_worker_count(unsigned int worker_count) {
+    // the buffers of the old workers are dropped
+    flush_commands();
+
+    m_thread_pool = std::make_unique<ThreadPool>(worker_count);
+    create_command_buffers();
 }
 
 // Event Methods
@@ -36,10 +122,113 @@ void Scene::send_event(EventId event_id) {
     m_event_manager->send_event(event_id);
 }
 
+void Scene::dispatch_queued_events() {
+    m_event_manager->dispatch_queued_events();
+}
+
+EventQueueStats Scene::get_event_queue_stats() const {
+    return m_event_manager->get_queue_stats();
+}
+
+change_tick_type Scene::get_change_tick() const {
+    return m_component_manager->get_change_tick();
+}
+
+change_tick_type Scene::advance_change_tick() {
+    return m_component_manager->advance_change_tick();
+}
+
 bool Scene::has_all_components(Entity entity) const {
     return m_component_manager->has_all_components(entity);
 }
 
+SceneStats Scene::get_stats() const {
+    return {m_entity_manager->get_stats(), m_component_manager->get_stats()};
+}
+
+void Scene::reset_churn() {
+    m_component_manager->reset_churn();
+}
+
 Signature Scene::get_entity_signature(Entity entity) const {
     return m_entity_manager->get_signature(entity);
-}
\ No newline at end of file
+}
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+std::vector<Archetype*> Scene::get_matching_archetypes(Signature required, Signature excluded, bool exclusive) const {
+    return m_component_manager->get_matching_archetypes(required, excluded, exclusive);
+}
+#else
+Query& Scene::get_query(Signature required, Signature excluded, bool exclusive) {
+    return m_entity_manager->get_query(required, excluded, exclusive, [this](ComponentType type) {
+        return m_component_manager->get_entities(type);
+    });
+}
+#endif
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+// Snapshot Methods
+SceneSnapshot Scene::save_snapshot() const {
+    if(!m_component_manager->can_save_snapshot())
+        return {};
+
+    SnapshotWriter writer;
+
+    /// A. header
+    SnapshotHeader header;
+    header.component_type_count = m_component_manager->count_registered_components();
+    header.change_tick = get_change_tick();
+    writer.write(header);
+
+    /// B. component types
+    m_component_manager->write_snapshot_types(writer);
+
+    /// C. entities
+    m_entity_manager->write_snapshot(writer);
+
+    /// D. components
+    m_component_manager->write_snapshot(writer);
+
+    return SceneSnapshot{writer.release()};
+}
+
+bool Scene::load_snapshot(const SceneSnapshot& snapshot) {
+    return load_snapshot(snapshot.data(), snapshot.size());
+}
+
+bool Scene::load_snapshot(const std::byte* data, std::size_t size) {
+    SnapshotReader reader{data, size};
+
+    /// A. header
+    SnapshotHeader header = reader.read<SnapshotHeader>();
+
+    if(reader.failed() || !header.is_supported() || header.component_type_count != m_component_manager->count_registered_components())
+        return false;
+
+    /// B. component types
+    std::vector<SnapshotComponentType> types;
+    for(std::uint32_t i = 0; i < header.component_type_count; i++)
+        types.push_back(reader.read<SnapshotComponentType>());
+
+    snapshot_type_map_type type_map;
+
+    if(reader.failed() || !m_component_manager->map_snapshot_types(types, type_map))
+        return false;
+
+    // read all of the snapshot once without loading it, so that a truncated or corrupt snapshot
+    // leaves the scene as it was. loading can not fail after that
+    SnapshotReader check_reader = reader;
+    SnapshotEntities entities;
+
+    if(!m_entity_manager->check_snapshot(check_reader, type_map, entities) || !m_component_manager->check_snapshot(check_reader, types, entities))
+        return false;
+
+    /// C. entities
+    m_entity_manager->read_snapshot(reader, type_map);
+
+    /// D. components
+    m_component_manager->read_snapshot(reader, types, header.change_tick);
+
+    return true;
+}
+#endif
\ No newline at end of file
@@ -3,11 +3,19 @@
 #include <memory>
 #include <functional>
 #include <utility>
+#include <type_traits>
+#include <vector>
 
 #include <engine/ecs/core/ComponentManager.hpp>
+#include <engine/ecs/core/ComponentObservers.hpp>
 #include <engine/ecs/core/EntityManager.hpp>
 #include <engine/ecs/core/SystemManager.hpp>
 #include <engine/ecs/core/EventManager.hpp>
+#include <engine/ecs/core/Prefab.hpp>
+#include <engine/ecs/core/SceneSnapshot.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
+
+#include <engine/threading/ThreadPool.hpp>
 
 #include <engine/ecs/core/Types.hpp>
 #include <engine/ecs/core/Event.hpp>
@@ -15,17 +23,26 @@
 // if InputHandler contains Scene& we will need to forward declare InputHandler
 // class InputHandler;
 
+class SceneCommandBuffer;
+
 class Scene {
 public:
-    Scene();
+    Scene(entity_count_size_type max_entities = DEFAULT_MAX_ENTITIES);
+    ~Scene();
     // void init();
 
 public:
     // Entity Methods
     Entity create_entity();
+    std::vector<Entity> create_entities(entity_count_size_type count, const Prefab& prefab); // `count` copies of the prefab
     Signature get_entity_signature(Entity entity) const;
     void destroy_entity(Entity entity);
 
+    // entity capacity can be raised (or lowered, down to the entities already created) at runtime.
+    // it is doubled when all entity ids are in use and an entity is created
+    void set_max_entities(entity_count_size_type max_entities);
+    entity_count_size_type get_max_entities() const;
+
 public:
     // Component Methods
     template<typename ...Args>
@@ -34,6 +51,10 @@ public:
     template<typename T>
     void add_component(Entity entity, T component);
 
+    // construct the component in place from `args`. the reference is valid until the next structural change
+    template<typename T, typename ...Args>
+    component_reference_t<T> emplace_component(Entity entity, Args&& ...args);
+
     template<typename T>
     void remove_component(Entity entity);
 
@@ -41,11 +62,39 @@ public:
     void add_components(Entity, Args&& ...components);
 
     template<typename T>
-    T& get_component(Entity entity);
+    component_reference_t<T> get_component(Entity entity); // `T&`, or a `SplitReference` (see SplitComponent.hpp)
+
+    // change tracking (see ChangeTicks.hpp)
+    template<typename T>
+    component_reference_t<T> get_mutable_component(Entity entity); // marks the component as changed
+
+    template<typename T>
+    void mark_changed(Entity entity);
+
+    change_tick_type get_change_tick() const;
+    change_tick_type advance_change_tick(); // returns the new tick
+
+    // sort the components of type T in place by `compare(const T&, const T&)`. views which require T
+    // then visit their entities in the order of the components, until entities join or leave the view
+    // (with an owning group of T, the entities of the group come first). must not be called while
+    // components of type T are iterated.
+    // with ECS_ARCHETYPE_STORAGE the rows of each archetype are sorted, which reorders all of its components
+    template<typename T, typename Compare>
+    void sort(Compare compare);
+
+    // order the components of type T as the components of type `Reference`, so that iterating
+    // both walks memory sequentially. views which require T follow the new order as with `sort`.
+    // T must not be owned by a group
+    template<typename T, typename Reference>
+    void sort_like();
 
     template<typename T>
     bool has_component(Entity entity) const;
 
+    // number of entities with a component of type T
+    template<typename T>
+    entity_count_size_type count_components() const;
+
     bool has_all_components(Entity entity) const;
     
     template<typename ...ComponentTypes>
@@ -54,25 +103,123 @@ public:
     template<typename T>
     ComponentType get_component_type() const;
 
+    // entity and per component type counts, memory and churn (see SceneStats.hpp).
+    // churn counts the changes since the last `reset_churn`
+    SceneStats get_stats() const;
+    void reset_churn(); // e.g. once per rendered frame, after reading the stats
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    std::vector<Archetype*> get_matching_archetypes(Signature required, Signature excluded, bool exclusive) const;
+#else
+    // cached list of the entities matching a signature pair (see QueryCache.hpp)
+    Query& get_query(Signature required, Signature excluded, bool exclusive);
+
+    template<typename T>
+    ComponentArray<std::remove_cvref_t<T>>* get_component_array();
+
+    // declares the owning group of the component types on first use (see `Group`)
     template<typename ...ComponentTypes>
-    std::pair<vector_entity_iterator, vector_entity_iterator> get_smallest_component_array();
+    OwningGroup& get_owning_group();
+#endif
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+public:
+    // Snapshot Methods (see SceneSnapshot.hpp)
+    // empty snapshot if a registered component type can not be saved (see `is_snapshot_component_v`)
+    SceneSnapshot save_snapshot() const;
+
+    // replace all entities and components with the snapshot's. returns false, and keeps the scene as
+    // it is, if the snapshot has another format version, other component types than the registered
+    // ones, or is truncated or corrupt, or if a registered component type can not be loaded
+    bool load_snapshot(const SceneSnapshot& snapshot);
+    bool load_snapshot(const std::byte* data, std::size_t size); // e.g. a memory mapped snapshot file
+#endif
+
+public:
+    // Observer Methods (see ComponentObservers.hpp)
+    template<typename T>
+    void on_added(ComponentObservers::observer_type observer);
+
+    template<typename T>
+    void on_removed(ComponentObservers::observer_type observer);
+
+    template<typename T>
+    void on_changed(ComponentObservers::observer_type observer);
+
+    // deliver the component events recorded since the last flush to the observers
+    void flush_observers();
+
+    // for views and groups, which record the changes written through them
+    ComponentObservers& get_observers() { return *m_observers; }
 
 public:
     // System Methods
     template<typename T, typename... Args>
     T& register_system(Args&& ...args);
 
+    // dispatch the queued events, then run all registered systems, independent systems run in parallel.
+    // the command buffers are played back once all systems are done, then the observers are flushed.
+    void update(float dt);
+
+public:
+    // Command Buffer Methods
+    // command buffer of the calling thread, for structural changes during iteration or from worker threads.
+    // every worker of the thread pool has its own buffer, the threads outside the pool share one buffer
+    // and must not record at the same time
+    SceneCommandBuffer& get_command_buffer();
+
+    // play back the command buffers of the workers in worker order, then the buffer of the threads outside
+    // the pool. the commands of one buffer are played back as documented in SceneCommandBuffer.hpp
+    void flush_commands();
+
+public:
+    // Thread Methods
+    ThreadPool& get_thread_pool(); // started on first use
+    void set_worker_count(unsigned int worker_count); // flushes the commands and restarts the thread pool with `worker_count` workers
+
 public:
     // Event Methods
     void add_event_listener(EventId event_id, const std::function<void(Event&)>& listener); // pass listener by reference
     void send_event(Event& event);
     void send_event(EventId event_id);
 
+    // typed events (see EventManager.hpp)
+    template<TypedEvent T>
+    void add_event_listener(void (*listener)(const T&));
+
+    template<auto Method, typename Class>
+    void add_event_listener(Class* instance);
+
+    template<TypedEvent T>
+    void send_event(const T& event);
+
+    // queue a typed event from any thread, it is dispatched by the next `update` (see EventManager.hpp)
+    template<TypedEvent T>
+    void queue_event(const T& event);
+
+    void dispatch_queued_events();
+    EventQueueStats get_event_queue_stats() const;
+
+private:
+    // one command buffer per worker of the new thread pool, keeping the buffer of the threads outside the pool
+    void create_command_buffers();
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    // reorder the cached queries which require T like the components of type T
+    template<typename T>
+    void order_queries_like();
+#endif
+
 private:
     std::unique_ptr<ComponentManager> m_component_manager;
     std::unique_ptr<EntityManager> m_entity_manager;
     std::unique_ptr<EventManager> m_event_manager;
     std::unique_ptr<SystemManager> m_system_manager;
+    std::unique_ptr<ThreadPool> m_thread_pool;
+    std::unique_ptr<ComponentObservers> m_observers;
+
+    // indexed by `ThreadPool::current_worker`, the last buffer is used by the threads outside the pool
+    std::vector<std::unique_ptr<SceneCommandBuffer>> m_command_buffers;
 };
 
 template<typename ...ComponentTypes>
@@ -87,20 +234,34 @@ void Scene::register_component() {
 
 template<typename T>
 void Scene::add_component(Entity entity, T component) {
-    m_component_manager->add_component<T>(entity, component);
+    emplace_component<T>(entity, std::move(component));
+}
 
+template<typename T, typename ...Args>
+component_reference_t<T> Scene::emplace_component(Entity entity, Args&& ...args) {
+    // tags are stored in the signature, which is set first
     auto signature = m_entity_manager->get_signature(entity);
+    assert(!signature.test(m_component_manager->get_component_type<T>()) && "Component added to same entity more than once.");
+
     signature.set(m_component_manager->get_component_type<T>(), true);
     m_entity_manager->set_signature(entity, signature);
+
+    m_observers->record(ComponentObservers::COMPONENT_ADDED, component_type_id<T>(), entity);
+
+    return m_component_manager->emplace_component<T>(entity, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
 void Scene::add_components(Entity entity, Args&& ...components) {
-    (m_component_manager->add_component<Args>(entity, std::forward<Args>(components)), ...);
-
     auto signature = m_entity_manager->get_signature(entity);
-    (signature.set(get_component_type<Args>(), true), ...);
+    assert((signature & get_components_signature<std::decay_t<Args>...>()).none() && "Component added to same entity more than once.");
+
+    signature |= get_components_signature<std::decay_t<Args>...>();
     m_entity_manager->set_signature(entity, signature);
+
+    (m_component_manager->add_component<std::decay_t<Args>>(entity, std::forward<Args>(components)), ...);
+
+    m_observers->record(ComponentObservers::COMPONENT_ADDED, get_components_signature<std::decay_t<Args>...>(), &entity, 1);
 }
 
 template<typename T>
@@ -110,13 +271,44 @@ void Scene::remove_component(Entity entity) {
     auto signature = m_entity_manager->get_signature(entity);
     signature.set(m_component_manager->get_component_type<T>(), false);
     m_entity_manager->set_signature(entity, signature);
+
+    m_observers->record(ComponentObservers::COMPONENT_REMOVED, component_type_id<T>(), entity);
 }
 
 template<typename T>
-T& Scene::get_component(Entity entity) {
+component_reference_t<T> Scene::get_component(Entity entity) {
     return m_component_manager->get_component<T>(entity);
 }
 
+template<typename T>
+component_reference_t<T> Scene::get_mutable_component(Entity entity) {
+    m_observers->record(ComponentObservers::COMPONENT_CHANGED, component_type_id<T>(), entity);
+
+    return m_component_manager->get_mutable_component<T>(entity);
+}
+
+template<typename T>
+void Scene::mark_changed(Entity entity) {
+    m_observers->record(ComponentObservers::COMPONENT_CHANGED, component_type_id<T>(), entity);
+
+    m_component_manager->mark_changed<T>(entity);
+}
+
+template<typename T>
+void Scene::on_added(ComponentObservers::observer_type observer) {
+    m_observers->add_observer(ComponentObservers::COMPONENT_ADDED, get_component_type<T>(), std::move(observer));
+}
+
+template<typename T>
+void Scene::on_removed(ComponentObservers::observer_type observer) {
+    m_observers->add_observer(ComponentObservers::COMPONENT_REMOVED, get_component_type<T>(), std::move(observer));
+}
+
+template<typename T>
+void Scene::on_changed(ComponentObservers::observer_type observer) {
+    m_observers->add_observer(ComponentObservers::COMPONENT_CHANGED, get_component_type<T>(), std::move(observer));
+}
+
 template<typename T>
 ComponentType Scene::get_component_type() const {
     return m_component_manager->get_component_type<T>();
@@ -127,12 +319,70 @@ T& Scene::register_system(Args&& ...args) {
     return m_system_manager->register_system<T>(*this, std::forward<Args>(args)...); // register system with the scene
 }
 
+#if !defined(ECS_ARCHETYPE_STORAGE)
+template<typename T>
+ComponentArray<std::remove_cvref_t<T>>* Scene::get_component_array() {
+    return m_component_manager->get_component_array<T>();
+}
+
 template<typename ...ComponentTypes>
-std::pair<vector_entity_iterator, vector_entity_iterator> Scene::get_smallest_component_array() {
-    return m_component_manager->get_smallest_component_array<ComponentTypes...>();
+OwningGroup& Scene::get_owning_group() {
+    return m_component_manager->get_owning_group<ComponentTypes...>();
+}
+#endif
+
+template<typename T, typename Compare>
+void Scene::sort(Compare compare) {
+    m_component_manager->sort<T>(compare);
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    order_queries_like<T>();
+#endif
+}
+
+template<typename T, typename Reference>
+void Scene::sort_like() {
+    m_component_manager->sort_like<T, Reference>();
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    order_queries_like<T>();
+#endif
+}
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+template<typename T>
+void Scene::order_queries_like() {
+    // views walk the cached queries, not the component array
+    m_entity_manager->order_queries(get_component_type<T>(), m_component_manager->get_entities(get_component_type<T>()));
 }
+#endif
 
 template<typename T>
 bool Scene::has_component(Entity entity) const {
     return m_component_manager->has_component<T>(entity);
+}
+
+template<typename T>
+entity_count_size_type Scene::count_components() const {
+    return m_component_manager->size_component_array<T>();
+}
+
+template<TypedEvent T>
+void Scene::add_event_listener(void (*listener)(const T&)) {
+    m_event_manager->add_listener(listener);
+}
+
+template<auto Method, typename Class>
+void Scene::add_event_listener(Class* instance) {
+    m_event_manager->add_listener<Method>(instance);
+}
+
+template<TypedEvent T>
+void Scene::send_event(const T& event) {
+    m_event_manager->send_event(event);
+}
+
+template<TypedEvent T>
+void Scene::queue_event(const T& event) {
+    m_event_manager->queue_event(event);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include <engine/ecs/core/SceneCommandBuffer.hpp>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+Entity SceneCommandBuffer::create_entity() {
+    return PLACEHOLDER_FLAG | m_created_count++;
+}
+
+void SceneCommandBuffer::destroy_entity(Entity entity) {
+    m_destroyed.push_back(entity);
+}
+
+void SceneCommandBuffer::playback(Scene& scene) {
+    std::vector<Entity> created;
+    created.reserve(m_created_count);
+
+    for(entity_count_size_type i = 0; i < m_created_count; i++) {
+        created.push_back(scene.create_entity());
+        assert(!is_placeholder(created.back()) && "Entity id overlaps command buffer placeholders");
+    }
+
+    for(ComponentType type : m_used_types)
+        m_component_commands[type]->playback(scene, created);
+
+    for(Entity entity : m_destroyed)
+        scene.destroy_entity(resolve(entity, created));
+
+    // clear
+    m_created_count = 0;
+    m_destroyed.clear();
+
+    for(ComponentType type : m_used_types)
+        m_component_commands[type]->clear();
+
+    m_used_types.clear();
+}
+
+bool SceneCommandBuffer::empty() const {
+    return m_created_count == 0 && m_destroyed.empty() && m_used_types.empty();
+}
+
+Entity SceneCommandBuffer::resolve(Entity entity, const std::vector<Entity>& created) {
+    if(!is_placeholder(entity))
+        return entity;
+
+    assert((entity & ~PLACEHOLDER_FLAG) < created.size() && "Placeholder entity from another command buffer");
+
+    return created[entity & ~PLACEHOLDER_FLAG];
+}
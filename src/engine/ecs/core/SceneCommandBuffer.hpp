@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/ComponentTypeId.hpp>
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// SceneCommandBuffer
+// Records structural changes (entity creation and destruction, component addition and removal)
+// to be played back later, so that they can be requested while views are being iterated or from
+// worker threads. A buffer is not thread safe: use one per thread (see `Scene::get_command_buffer`).
+//
+// Playback applies the commands in batches:
+//  1. entities are created
+//  2. component commands, one component type at a time (in the order the types were first used),
+//     and in recording order within a type
+//  3. entities are destroyed
+//
+// Entities created through a buffer get a placeholder id, which can only be used with the same buffer.
+
+class SceneCommandBuffer {
+public:
+    Entity create_entity(); // returns a placeholder entity
+    void destroy_entity(Entity entity);
+
+    template<typename T>
+    void add_component(Entity entity, T component);
+
+    template<typename T>
+    void remove_component(Entity entity);
+
+    // apply all recorded commands to the scene and clear the buffer
+    void playback(Scene& scene);
+
+    bool empty() const;
+
+    static bool is_placeholder(Entity entity) { return entity & PLACEHOLDER_FLAG; }
+
+private:
+    // a placeholder entity is the index of the entity among the ones created at playback, with the top bit set
+    static constexpr Entity PLACEHOLDER_FLAG = Entity(1) << 31;
+
+    static Entity resolve(Entity entity, const std::vector<Entity>& created);
+
+    class IComponentCommands {
+    public:
+        virtual ~IComponentCommands() = default;
+        virtual void playback(Scene& scene, const std::vector<Entity>& created) = 0;
+
+        virtual bool empty() const = 0;
+        virtual void clear() = 0; // keeps the allocated memory for the next commands
+    };
+
+    template<typename T>
+    class ComponentCommands : public IComponentCommands {
+    public:
+        void add(Entity entity, T component);
+        void remove(Entity entity);
+
+        void playback(Scene& scene, const std::vector<Entity>& created);
+
+        bool empty() const { return m_commands.empty(); }
+        void clear() { m_commands.clear(); m_added.clear(); }
+
+    private:
+        struct Command {
+            Entity entity;
+            bool add;
+        };
+
+        std::vector<Command> m_commands;
+        std::vector<T> m_added; // components of the add commands, in order
+    };
+
+    template<typename T>
+    ComponentCommands<T>& get_component_commands();
+
+private:
+    entity_count_size_type m_created_count = 0;
+    std::vector<Entity> m_destroyed;
+
+    std::array<std::unique_ptr<IComponentCommands>, MAX_COMPONENTS> m_component_commands;
+    std::vector<ComponentType> m_used_types; // component types with commands, in order of first use
+};
+
+template<typename T>
+void SceneCommandBuffer::add_component(Entity entity, T component) {
+    get_component_commands<T>().add(entity, std::move(component));
+}
+
+template<typename T>
+void SceneCommandBuffer::remove_component(Entity entity) {
+    get_component_commands<T>().remove(entity);
+}
+
+template<typename T>
+SceneCommandBuffer::ComponentCommands<T>& SceneCommandBuffer::get_component_commands() {
+    ComponentType type = component_type_id<T>();
+
+    if(!m_component_commands[type])
+        m_component_commands[type] = std::make_unique<ComponentCommands<T>>();
+
+    if(m_component_commands[type]->empty())
+        m_used_types.push_back(type);
+
+    return *static_cast<ComponentCommands<T>*>(m_component_commands[type].get());
+}
+
+template<typename T>
+void SceneCommandBuffer::ComponentCommands<T>::add(Entity entity, T component) {
+    m_commands.push_back({entity, true});
+    m_added.push_back(std::move(component));
+}
+
+template<typename T>
+void SceneCommandBuffer::ComponentCommands<T>::remove(Entity entity) {
+    m_commands.push_back({entity, false});
+}
+
+template<typename T>
+void SceneCommandBuffer::ComponentCommands<T>::playback(Scene& scene, const std::vector<Entity>& created) {
+    std::size_t next_added = 0;
+
+    for(const Command& command : m_commands) {
+        Entity entity = resolve(command.entity, created);
+
+        if(command.add)
+            scene.add_component<T>(entity, std::move(m_added[next_added++]));
+        else
+            scene.remove_component<T>(entity);
+    }
+}
@@ -0,0 +1,69 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include <engine/ecs/core/SceneSnapshot.hpp>
+
+#include <engine/ecs/core/Types.hpp>
+
+bool SnapshotHeader::is_supported() const {
+    return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION && endian_check == ENDIAN_CHECK;
+}
+
+/// SnapshotWriter
+
+void SnapshotWriter::write_bytes(const void* bytes, std::size_t size) {
+    const std::byte* begin = static_cast<const std::byte*>(bytes);
+    m_bytes.insert(m_bytes.end(), begin, begin + size);
+}
+
+void SnapshotWriter::align() {
+    m_bytes.resize((m_bytes.size() + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT);
+}
+
+/// SnapshotReader
+
+SnapshotReader::SnapshotReader(const std::byte* data, std::size_t size): m_data{data}, m_size{size} {
+    // arrays are read in place
+    m_failed = reinterpret_cast<std::uintptr_t>(data) % SNAPSHOT_ALIGNMENT != 0;
+}
+
+const std::byte* SnapshotReader::read_bytes(std::size_t size) {
+    // truncated snapshot
+    if(m_failed || m_position > m_size || size > m_size - m_position) {
+        m_failed = true;
+        return nullptr;
+    }
+
+    const std::byte* bytes = m_data + m_position;
+    m_position += size;
+
+    return bytes;
+}
+
+void SnapshotReader::align() {
+    m_position = (m_position + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+/// SceneSnapshot
+
+bool SceneSnapshot::write_file(const std::string& path) const {
+    std::ofstream ofs {path, std::ios::binary};
+    ofs.write(reinterpret_cast<const char*>(m_bytes.data()), m_bytes.size());
+
+    return ofs.good();
+}
+
+SceneSnapshot SceneSnapshot::read_file(const std::string& path) {
+    std::ifstream ifs {path, std::ios::binary | std::ios::ate};
+
+    if(!ifs)
+        return {};
+
+    std::vector<std::byte> bytes(static_cast<std::size_t>(ifs.tellg()));
+
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+    return ifs ? SceneSnapshot{std::move(bytes)} : SceneSnapshot{};
+}
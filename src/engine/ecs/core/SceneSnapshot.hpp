@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/ChangeTicks.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// Scene snapshots (sparse set storage only)
+// A snapshot is a versioned binary image of the entities and components of a `Scene`:
+//      SceneSnapshot snapshot = scene.save_snapshot();
+//      ...
+//      scene.load_snapshot(snapshot); // roll back
+//
+// Layout, every array starts at a multiple of SNAPSHOT_ALIGNMENT:
+//  A. SnapshotHeader
+//  B. SnapshotComponentType for every registered component type, in registration order
+//  C. entities: SnapshotEntitiesHeader, living entities, their signatures, destroyed entities
+//  D. components, for every component type of B: entities, change ticks, components
+//
+// Components are written as raw blocks, so only trivially copyable component types can be saved.
+// A scene with other component types registered saves an empty snapshot and loads none.
+// A snapshot can be loaded from any memory with the alignment of SNAPSHOT_ALIGNMENT (such as a
+// memory mapped file), and is loaded with one copy per array.
+// Snapshots can be loaded into a scene with the same component types registered in the same order.
+
+const std::size_t SNAPSHOT_ALIGNMENT = alignof(std::max_align_t);
+
+struct SnapshotHeader {
+    static constexpr char MAGIC[4] = {'E', 'C', 'S', 'S'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t ENDIAN_CHECK = 0x01020304; // snapshots are not portable across byte orders
+
+    char magic[4] = {MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]};
+    std::uint32_t version = VERSION;
+    std::uint32_t endian_check = ENDIAN_CHECK;
+    std::uint32_t component_type_count = 0;
+    change_tick_type change_tick = 0;
+
+    bool is_supported() const;
+};
+
+struct SnapshotComponentType {
+    std::uint32_t type; // component type id in the saving process
+    std::uint32_t size; // sizeof the component
+    entity_count_size_type count;
+};
+
+// registered component type of each component type id of the saving process
+using snapshot_type_map_type = std::array<ComponentType, MAX_COMPONENTS>;
+
+struct SnapshotEntitiesHeader {
+    entity_count_size_type living_count;
+    entity_count_size_type destroyed_count;
+    Entity last_entity;
+    entity_count_size_type max_entities;
+};
+
+class SnapshotWriter {
+public:
+    template<typename T>
+    void write(const T& value);
+
+    // `count` values, starting at the next multiple of SNAPSHOT_ALIGNMENT
+    template<typename T>
+    void write_array(const T* values, std::size_t count);
+
+    void write_bytes(const void* bytes, std::size_t size);
+    void align(); // pad to the next multiple of SNAPSHOT_ALIGNMENT
+
+    std::vector<std::byte> release() { return std::move(m_bytes); }
+
+private:
+    std::vector<std::byte> m_bytes;
+};
+
+// Reads past the end of the snapshot fail: they return zeroed values or nullptr, and the reader
+// stays failed. Unaligned data fails the reader as well.
+class SnapshotReader {
+public:
+    SnapshotReader(const std::byte* data, std::size_t size);
+
+    template<typename T>
+    T read();
+
+    // pointer to `count` values inside the snapshot, see `SnapshotWriter::write_array`
+    template<typename T>
+    const T* read_array(std::size_t count);
+
+    const std::byte* read_bytes(std::size_t size);
+    void align();
+
+    bool failed() const { return m_failed; }
+
+private:
+    const std::byte* m_data;
+    std::size_t m_size;
+    std::size_t m_position = 0;
+    bool m_failed = false;
+};
+
+// living entities of a snapshot, with their signatures in the registered component types.
+// filled while checking a snapshot, before it is loaded
+struct SnapshotEntities {
+    std::unordered_map<Entity, Signature> signatures;
+    std::array<entity_count_size_type, MAX_COMPONENTS> component_counts {}; // entities with each component type
+};
+
+class SceneSnapshot {
+public:
+    SceneSnapshot() = default;
+    explicit SceneSnapshot(std::vector<std::byte> bytes): m_bytes{std::move(bytes)} {}
+
+    const std::byte* data() const { return m_bytes.data(); }
+    std::size_t size() const { return m_bytes.size(); }
+    bool empty() const { return m_bytes.empty(); }
+
+    // snapshots of identical scenes are identical, so world states can be compared byte for byte
+    bool operator==(const SceneSnapshot& other) const = default;
+
+    bool write_file(const std::string& path) const;
+    static SceneSnapshot read_file(const std::string& path); // empty snapshot if the file can not be read
+
+private:
+    std::vector<std::byte> m_bytes;
+};
+
+template<typename T>
+void SnapshotWriter::write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Snapshot values must be trivially copyable");
+
+    write_bytes(&value, sizeof(T));
+}
+
+template<typename T>
+void SnapshotWriter::write_array(const T* values, std::size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>, "Snapshot values must be trivially copyable");
+    static_assert(alignof(T) <= SNAPSHOT_ALIGNMENT, "Snapshot value alignment exceeds SNAPSHOT_ALIGNMENT");
+
+    align();
+    write_bytes(values, count * sizeof(T));
+}
+
+template<typename T>
+T SnapshotReader::read() {
+    T value {};
+
+    if(const std::byte* bytes = read_bytes(sizeof(T)))
+        std::memcpy(&value, bytes, sizeof(T));
+
+    return value;
+}
+
+template<typename T>
+const T* SnapshotReader::read_array(std::size_t count) {
+    align();
+
+    if(count > m_size / sizeof(T)) {
+        m_failed = true;
+        return nullptr;
+    }
+
+    return reinterpret_cast<const T*>(read_bytes(count * sizeof(T)));
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <engine/ecs/core/Types.hpp>
+
+// Memory and occupancy statistics of a `Scene` (see `Scene::get_stats`), to size entity and
+// component capacities and to spot leaks in long sessions.
+
+// components added and removed since the last `Scene::reset_churn`
+struct ComponentChurn {
+    std::size_t adds = 0;
+    std::size_t removes = 0;
+    std::size_t swap_removes = 0; // removals which moved the last component into the removed one's place
+};
+
+struct ComponentStats {
+    ComponentType type;
+    std::string name;
+
+    entity_count_size_type count = 0; // entities with the component
+    std::size_t capacity = 0;         // components which fit without allocating
+
+    // components with their entities and change ticks
+    std::size_t bytes_used = 0;
+    std::size_t bytes_reserved = 0;
+
+    std::size_t sparse_bytes = 0; // allocated pages of the sparse array
+
+    ComponentChurn churn; // sparse set storage only
+};
+
+struct EntityStats {
+    entity_count_size_type living = 0;
+    entity_count_size_type max_entities = 0;
+    entity_count_size_type ids_used = 0;       // entity ids handed out so far
+    entity_count_size_type free_list = 0;      // destroyed entities waiting to be reused
+
+    std::size_t bytes_reserved = 0; // entities, signatures and their sparse array
+};
+
+struct SceneStats {
+    EntityStats entities;
+    std::vector<ComponentStats> components; // in registration order
+
+    std::size_t total_bytes_reserved() const;
+};
+
+inline std::size_t SceneStats::total_bytes_reserved() const {
+    std::size_t bytes = entities.bytes_reserved;
+
+    for(const ComponentStats& component : components)
+        bytes += component.bytes_reserved + component.sparse_bytes;
+
+    return bytes;
+}
@@ -1,3 +1,14 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/ChangeTicks.hpp>
 #include <engine/ecs/core/Scene.hpp>
 #include <engine/ecs/core/Types.hpp>
 
@@ -6,104 +17,451 @@
 template<typename ...ExcludeTypes>
 struct SceneViewExclude {};
 
+// SceneViewChanged, SceneViewAdded
+// Only select entities whose components of the given types were changed (or added) at or after
+// tick `since`. The types must be component types of the view.
+
+template<typename ...ChangedTypes>
+struct SceneViewChanged { change_tick_type since; };
+
+template<typename ...AddedTypes>
+struct SceneViewAdded { change_tick_type since; };
+
+// types which `each` passes by non-const reference and marks as changed. tags have no components
+template<typename ...ComponentTypes>
+Signature written_components_signature() {
+    Signature signature;
+    ((std::is_const_v<ComponentTypes> || is_tag_component_v<ComponentTypes> || (signature.set(component_type_id<std::remove_const_t<ComponentTypes>>()), true)), ...);
+
+    return signature;
+}
+
 // SceneView
+// Iterates the entities which have all of `ComponentTypes` (and none of the excluded types),
+// either as a range of entities:
+//      for(Entity entity : SceneView<A, B>(scene)) { auto& a = scene.get_component<A>(entity); ... }
+// or with `each`, which passes the components resolved during the join to the callback:
+//      SceneView<A, B>(scene).each([](Entity entity, A& a, B& b) { ... });
+// Split components are passed as `component_reference_t<T>` (see SplitComponent.hpp).
+// `parallel_each` splits the view into chunks which run on the thread pool of the scene. It is
+// safe as long as the callback only writes the components of the entity it is called with.
+//
+// `each` marks the components of non-const types as changed for every entity it visits, and records
+// them for the `on_changed` observers of their types, so components which are only read should be
+// given as const types: SceneView<A, const B>. The changes are collected per chunk and recorded once
+// per chunk, only for observed types.
+//
+// Signatures are computed once when the view is constructed. Without ECS_ARCHETYPE_STORAGE the
+// view walks the scene's cached query of its signatures, which lists exactly the matching entities,
+// and only looks up the components of types which are not tags (see ComponentTypeId.hpp).
+// Tag types have no change ticks, so they cannot be used in the change filters.
+// Entities and components must not be created or removed while a view is being iterated.
 
 template<typename ...ComponentTypes>
 class SceneView {
 public:
     class iterator;
-    
+
     template<typename ...ExcludeTypes>
     SceneView(Scene& scene, SceneViewExclude<ExcludeTypes...> exclude);
-    
+
+    template<typename ...ChangedTypes>
+    SceneView(Scene& scene, SceneViewChanged<ChangedTypes...> changed);
+
+    template<typename ...AddedTypes>
+    SceneView(Scene& scene, SceneViewAdded<AddedTypes...> added);
+
     SceneView(Scene& scene, bool exclusive = false);
 
     iterator begin() const { return m_begin; }
     iterator end() const { return m_end; }
 
+    // call `func(Entity, ComponentTypes&...)` for every entity in the view
+    template<typename Func>
+    void each(Func&& func) const;
+
+    // `each` over chunks of the view on the scene's thread pool. returns when all chunks are done
+    template<typename Func>
+    void parallel_each(Func&& func) const;
+
+    // chunks of fewer entities are not worth the scheduling overhead
+    static constexpr std::size_t MIN_PARALLEL_CHUNK = 1024;
+
+private:
+    SceneView(Scene& scene, bool exclusive, Signature excluded);
+
+    void set_tick_filter(Signature& filter, Signature types, change_tick_type since);
+    bool has_tick_filter() const { return m_changed_filter.any() || m_added_filter.any(); }
+    bool passes_tick_filter(ComponentType type, const ComponentTicks& ticks) const;
+
+    using index_sequence_type = std::index_sequence_for<ComponentTypes...>;
+
+    // written types with `on_changed` observers
+    Signature observed_writes() const;
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    bool passes_tick_filter(Archetype* archetype, entity_count_size_type row) const;
+
+    template<typename Func, std::size_t ...Is>
+    void each_in_chunk(Archetype* archetype, std::size_t chunk, Func& func, std::index_sequence<Is...>) const;
+
+    // tag columns take no space, so all rows share the tag instance
+    template<typename T>
+    static component_reference_t<T> get_data_at(T* column, entity_count_size_type row) {
+        if constexpr(is_tag_component_v<T>)
+            return tag_component<T>();
+        else
+            return column[row];
+    }
+#else
+    bool passes_tick_filter(Entity entity) const;
+
+    template<typename T>
+    ComponentArray<std::remove_const_t<T>>* get_component_array() const {
+        return std::get<ComponentArray<std::remove_const_t<T>>*>(m_component_arrays);
+    }
+
+    // index of the component of `entity` in its array. tags are not stored, so no lookup is made
+    template<typename T>
+    entity_count_size_type get_index(Entity entity) const;
+
+    template<typename T>
+    component_reference_t<T> get_data_at(entity_count_size_type index) const;
+
+    template<typename Func, std::size_t ...Is>
+    void each_in_range(vector_entity_iterator begin, vector_entity_iterator end, Func& func, std::index_sequence<Is...>) const;
+#endif
+
 private:
     Scene* const m_scene;
 
     bool m_exclusive;
+    Signature m_required;
     Signature m_excluded; // default std::bitset is all zero's
 
+    Signature m_changed_filter;
+    Signature m_added_filter;
+    change_tick_type m_since = 0;
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    std::vector<Archetype*> m_archetypes; // archetypes matching the view
+#else
+    // matching entities, from the query cache
+    vector_entity_iterator m_matches_begin;
+    vector_entity_iterator m_matches_end;
+
+    std::tuple<ComponentArray<std::remove_const_t<ComponentTypes>>*...> m_component_arrays; // nullptr for tags
+#endif
+
     iterator m_begin;
     iterator m_end;
 };
 
 /// SceneView Iterator
 
+#if defined(ECS_ARCHETYPE_STORAGE)
+// Walks the rows of every matching archetype in order. All entities of a
+// matching archetype are valid, so no per entity signature checks are needed.
+// Rows are only skipped for the change tick filters.
 template<typename ...ComponentTypes>
 class SceneView<ComponentTypes...>::iterator {
 public:
     iterator() {}
-    iterator(vector_entity_iterator it, SceneView* scene): vec_iterator{it}, scene_view{scene} {}
+    iterator(std::size_t archetype, entity_count_size_type row, const SceneView* scene):
+        archetype_index{archetype}, row{row}, scene_view{scene} { skip_invalid_rows(); }
 
     iterator& operator++();
-    
-    bool is_valid_entity(const iterator& it) const;
-    
-    bool operator==(const iterator& other) const { return !operator!=(other);  }
-    
-    bool operator!=(const iterator& other) const;
 
-    const Entity& operator*() const { return *vec_iterator; }
+    bool operator==(const iterator& other) const { return archetype_index == other.archetype_index && row == other.row; }
+
+    bool operator!=(const iterator& other) const { return !operator==(other); }
+
+    const Entity& operator*() const { return scene_view->m_archetypes[archetype_index]->get_entity(row); }
 
 private:
-    vector_entity_iterator vec_iterator;
-    SceneView* scene_view;
-    mutable bool first_check = true;
+    void skip_empty_archetypes();
+    void skip_invalid_rows();
+
+    std::size_t archetype_index;
+    entity_count_size_type row;
+    const SceneView* scene_view;
 };
 
 template<typename ...ComponentTypes>
-bool SceneView<ComponentTypes...>::iterator::operator!=(const iterator& other) const {
-    if(first_check) {
-        first_check = false;
-    
-        // check that vector iterators are unequal (equal when this->vec_iterator == end()),
-        // before calling is_valid_entity with `*this`
-        return (vec_iterator != other.vec_iterator) && is_valid_entity(*this); 
-    } else {
-        return (vec_iterator != other.vec_iterator);
+void SceneView<ComponentTypes...>::iterator::skip_empty_archetypes() {
+    while(archetype_index < scene_view->m_archetypes.size() && row >= scene_view->m_archetypes[archetype_index]->size()) {
+        archetype_index++;
+        row = 0;
     }
 }
 
 template<typename ...ComponentTypes>
-bool SceneView<ComponentTypes...>::iterator::is_valid_entity(const iterator& it) const {
-    Signature signature_required = scene_view->m_scene->get_components_signature<ComponentTypes...>();
-    Signature signature_entity = scene_view->m_scene->get_entity_signature(*it.vec_iterator);
+void SceneView<ComponentTypes...>::iterator::skip_invalid_rows() {
+    skip_empty_archetypes();
+
+    if(!scene_view->has_tick_filter())
+        return;
 
-    return ( 
-        (!scene_view->m_exclusive &&
-            (signature_entity & scene_view->m_excluded).none() &&
-            (signature_required & signature_entity) == signature_required) ||
-        (scene_view->m_exclusive && signature_required == signature_entity)
-    );
+    while(archetype_index < scene_view->m_archetypes.size() && !scene_view->passes_tick_filter(scene_view->m_archetypes[archetype_index], row)) {
+        row++;
+        skip_empty_archetypes();
+    }
 }
 
 template<typename ...ComponentTypes>
 typename SceneView<ComponentTypes...>::iterator& SceneView<ComponentTypes...>::iterator::operator++() {
-    do
+    row++;
+    skip_invalid_rows();
+
+    return *this;
+}
+#else
+// Walks the matching entities, only skipping the ones which do not pass the change tick filters
+template<typename ...ComponentTypes>
+class SceneView<ComponentTypes...>::iterator {
+public:
+    iterator() {}
+    iterator(vector_entity_iterator it, vector_entity_iterator end, const SceneView* scene):
+        vec_iterator{it}, vec_end{end}, scene_view{scene} { skip_invalid_entities(); }
+
+    iterator& operator++();
+
+    bool operator==(const iterator& other) const { return vec_iterator == other.vec_iterator; }
+
+    bool operator!=(const iterator& other) const { return !operator==(other); }
+
+    const Entity& operator*() const { return *vec_iterator; }
+
+private:
+    void skip_invalid_entities();
+
+    vector_entity_iterator vec_iterator;
+    vector_entity_iterator vec_end;
+    const SceneView* scene_view;
+};
+
+template<typename ...ComponentTypes>
+void SceneView<ComponentTypes...>::iterator::skip_invalid_entities() {
+    if(!scene_view->has_tick_filter())
+        return;
+
+    while(vec_iterator != vec_end && !scene_view->passes_tick_filter(*vec_iterator))
         vec_iterator++;
-    while(*this != scene_view->end() && !is_valid_entity(*this));
+}
+
+template<typename ...ComponentTypes>
+typename SceneView<ComponentTypes...>::iterator& SceneView<ComponentTypes...>::iterator::operator++() {
+    vec_iterator++;
+    skip_invalid_entities();
 
     return *this;
 }
+#endif
 
 // SceneView Methods
 
 template<typename ...ComponentTypes>
 template<typename ...ExcludeTypes>
-SceneView<ComponentTypes...>::SceneView(Scene& scene, SceneViewExclude<ExcludeTypes...> exclude): SceneView(scene) {
-    m_excluded = m_scene->get_components_signature<ExcludeTypes...>();
+SceneView<ComponentTypes...>::SceneView(Scene& scene, SceneViewExclude<ExcludeTypes...> exclude):
+    SceneView(scene, false, scene.get_components_signature<ExcludeTypes...>()) {}
+
+template<typename ...ComponentTypes>
+template<typename ...ChangedTypes>
+SceneView<ComponentTypes...>::SceneView(Scene& scene, SceneViewChanged<ChangedTypes...> changed): SceneView(scene, false, Signature{}) {
+    set_tick_filter(m_changed_filter, scene.get_components_signature<ChangedTypes...>(), changed.since);
+}
+
+template<typename ...ComponentTypes>
+template<typename ...AddedTypes>
+SceneView<ComponentTypes...>::SceneView(Scene& scene, SceneViewAdded<AddedTypes...> added): SceneView(scene, false, Signature{}) {
+    set_tick_filter(m_added_filter, scene.get_components_signature<AddedTypes...>(), added.since);
 }
 
 template<typename ...ComponentTypes>
-SceneView<ComponentTypes...>::SceneView(Scene& scene, bool exclusive): m_scene{&scene} {
+SceneView<ComponentTypes...>::SceneView(Scene& scene, bool exclusive): SceneView(scene, exclusive, Signature{}) {}
+
+template<typename ...ComponentTypes>
+SceneView<ComponentTypes...>::SceneView(Scene& scene, bool exclusive, Signature excluded): m_scene{&scene} {
     m_exclusive = exclusive;
+    m_required = m_scene->get_components_signature<ComponentTypes...>();
+    m_excluded = excluded;
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_archetypes = m_scene->get_matching_archetypes(m_required, m_excluded, m_exclusive);
+
+    m_begin = iterator{0, 0, this};
+    m_end = iterator{m_archetypes.size(), 0, this};
+#else
+    Query& query = m_scene->get_query(m_required, m_excluded, m_exclusive);
+    m_matches_begin = query.begin();
+    m_matches_end = query.end();
+
+    m_component_arrays = std::make_tuple(m_scene->get_component_array<ComponentTypes>()...);
+
+    m_begin = iterator{m_matches_begin, m_matches_end, this};
+    m_end = iterator{m_matches_end, m_matches_end, this};
+#endif
+}
+
+template<typename ...ComponentTypes>
+void SceneView<ComponentTypes...>::set_tick_filter(Signature& filter, Signature types, change_tick_type since) {
+    assert((types & m_required) == types && "Filtered component types must be in the view");
+    assert(((!is_tag_component_v<ComponentTypes> || !types.test(component_type_id<ComponentTypes>())) && ...) && "Tag components have no change ticks");
+
+    filter = types;
+    m_since = since;
+
+    // the iterators were positioned before the filter was set
+#if defined(ECS_ARCHETYPE_STORAGE)
+    m_begin = iterator{0, 0, this};
+#else
+    m_begin = iterator{m_matches_begin, m_matches_end, this};
+#endif
+}
+
+template<typename ...ComponentTypes>
+Signature SceneView<ComponentTypes...>::observed_writes() const {
+    return m_scene->get_observers().get_observed(ComponentObservers::COMPONENT_CHANGED) & written_components_signature<ComponentTypes...>();
+}
+
+template<typename ...ComponentTypes>
+bool SceneView<ComponentTypes...>::passes_tick_filter(ComponentType type, const ComponentTicks& ticks) const {
+    return (!m_changed_filter.test(type) || ticks.changed >= m_since) && (!m_added_filter.test(type) || ticks.added >= m_since);
+}
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+template<typename ...ComponentTypes>
+bool SceneView<ComponentTypes...>::passes_tick_filter(Archetype* archetype, entity_count_size_type row) const {
+    return (passes_tick_filter(component_type_id<ComponentTypes>(), archetype->get_ticks(row, component_type_id<ComponentTypes>())) && ...);
+}
+#else
+template<typename ...ComponentTypes>
+bool SceneView<ComponentTypes...>::passes_tick_filter(Entity entity) const {
+    return ((is_tag_component_v<ComponentTypes> || passes_tick_filter(component_type_id<ComponentTypes>(),
+        get_component_array<ComponentTypes>()->get_ticks_at(get_index<ComponentTypes>(entity)))) && ...);
+}
+
+template<typename ...ComponentTypes>
+template<typename T>
+entity_count_size_type SceneView<ComponentTypes...>::get_index(Entity entity) const {
+    if constexpr(is_tag_component_v<T>)
+        return 0;
+    else
+        return get_component_array<T>()->get_index(entity);
+}
+
+template<typename ...ComponentTypes>
+template<typename T>
+component_reference_t<T> SceneView<ComponentTypes...>::get_data_at(entity_count_size_type index) const {
+    if constexpr(is_tag_component_v<T>)
+        return tag_component<T>();
+    else
+        return get_component_array<T>()->get_data_at(index);
+}
+#endif
+
+template<typename ...ComponentTypes>
+template<typename Func>
+void SceneView<ComponentTypes...>::each(Func&& func) const {
+#if defined(ECS_ARCHETYPE_STORAGE)
+    // linear scan over the chunk columns of every matching archetype
+    for(Archetype* archetype : m_archetypes)
+        for(std::size_t chunk = 0; chunk < archetype->count_chunks(); chunk++)
+            each_in_chunk(archetype, chunk, func, index_sequence_type{});
+#else
+    each_in_range(m_matches_begin, m_matches_end, func, index_sequence_type{});
+#endif
+}
+
+template<typename ...ComponentTypes>
+template<typename Func>
+void SceneView<ComponentTypes...>::parallel_each(Func&& func) const {
+    ThreadPool& thread_pool = m_scene->get_thread_pool();
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    // archetype chunks are the unit of work
+    std::vector<std::pair<Archetype*, std::size_t>> chunks;
+
+    for(Archetype* archetype : m_archetypes)
+        for(std::size_t chunk = 0; chunk < archetype->count_chunks(); chunk++)
+            chunks.emplace_back(archetype, chunk);
+
+    thread_pool.parallel_for(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for(std::size_t i = begin; i < end; i++)
+            each_in_chunk(chunks[i].first, chunks[i].second, func, index_sequence_type{});
+    });
+#else
+    // split the matching entities into a few chunks per thread, so that threads which finish early can steal work
+    std::size_t count = m_matches_end - m_matches_begin;
+    std::size_t grain = std::max(MIN_PARALLEL_CHUNK, count / ((thread_pool.count_workers() + 1) * 4));
+
+    thread_pool.parallel_for(count, grain, [&](std::size_t begin, std::size_t end) {
+        each_in_range(m_matches_begin + begin, m_matches_begin + end, func, index_sequence_type{});
+    });
+#endif
+}
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+template<typename ...ComponentTypes>
+template<typename Func, std::size_t ...Is>
+void SceneView<ComponentTypes...>::each_in_chunk(Archetype* archetype, std::size_t chunk, Func& func, std::index_sequence<Is...>) const {
+    const Entity* entities = archetype->chunk_entities(chunk);
+    std::tuple<ComponentTypes*...> columns {archetype->chunk_column<ComponentTypes>(chunk, component_type_id<ComponentTypes>())...};
+    std::array<ComponentTicks*, sizeof...(ComponentTypes)> ticks {archetype->chunk_ticks(chunk, component_type_id<ComponentTypes>())...};
+
+    entity_count_size_type chunk_size = archetype->chunk_size(chunk);
+    bool check_ticks = has_tick_filter();
+    change_tick_type tick = m_scene->get_change_tick();
+
+    Signature observed = observed_writes();
+    bool record_changes = observed.any();
+    std::vector<Entity> changed;
 
-    auto [begin, end] = m_scene->get_smallest_component_array<ComponentTypes...>();
+    for(entity_count_size_type i = 0; i < chunk_size; i++) {
+        if(check_ticks && !(passes_tick_filter(component_type_id<ComponentTypes>(), ticks[Is][i]) && ...))
+            continue;
 
-    m_begin = iterator{begin, this};
-    m_end = iterator{end, this};
-}
\ No newline at end of file
+        func(entities[i], get_data_at<ComponentTypes>(std::get<Is>(columns), i)...);
+
+        // components passed by non-const reference may have been written
+        ((std::is_const_v<ComponentTypes> || (ticks[Is][i].changed = tick, true)), ...);
+
+        if(record_changes)
+            changed.push_back(entities[i]);
+    }
+
+    if(!changed.empty())
+        m_scene->get_observers().record(ComponentObservers::COMPONENT_CHANGED, observed, changed.data(), changed.size());
+}
+#else
+template<typename ...ComponentTypes>
+template<typename Func, std::size_t ...Is>
+void SceneView<ComponentTypes...>::each_in_range(vector_entity_iterator begin, vector_entity_iterator end, Func& func, std::index_sequence<Is...>) const {
+    // all entities match, so no signature checks are needed
+    bool check_ticks = has_tick_filter();
+
+    Signature observed = observed_writes();
+    bool record_changes = observed.any();
+    std::vector<Entity> changed;
+
+    for(auto it = begin; it != end; it++) {
+        Entity entity = *it;
+
+        std::array<entity_count_size_type, sizeof...(ComponentTypes)> indices {get_index<ComponentTypes>(entity)...};
+
+        if(check_ticks && !((is_tag_component_v<ComponentTypes> || passes_tick_filter(component_type_id<ComponentTypes>(), std::get<Is>(m_component_arrays)->get_ticks_at(indices[Is]))) && ...))
+            continue;
+
+        func(entity, get_data_at<ComponentTypes>(indices[Is])...);
+
+        // components passed by non-const reference may have been written
+        ((std::is_const_v<ComponentTypes> || is_tag_component_v<ComponentTypes> || (std::get<Is>(m_component_arrays)->mark_changed_at(indices[Is]), true)), ...);
+
+        if(record_changes)
+            changed.push_back(entity);
+    }
+
+    if(!changed.empty())
+        m_scene->get_observers().record(ComponentObservers::COMPONENT_CHANGED, observed, changed.data(), changed.size());
+}
+#endif
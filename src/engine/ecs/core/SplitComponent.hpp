@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <engine/ecs/core/SceneSnapshot.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// Split components (sparse set storage only)
+// The components of a type which specializes `component_fields` are stored as one stream per
+// field (SoA) instead of one array of components, so that a loop over one field only loads that field:
+//      template<>
+//      struct component_fields<Components::Transform> {
+//          using type = ComponentFields<&Components::Transform::position, &Components::Transform::rotation, &Components::Transform::scale>;
+//      };
+// The fields must be all the data members of the type, and the type default constructible.
+//
+// A split component is accessed through a `SplitReference` (`component_reference_t<T>`, which is
+// `T&` for the other types), pointing to the fields of one component:
+//      component_reference_t<Components::Transform> transform = scene.get_component<Components::Transform>(entity);
+//      transform.get<&Components::Transform::position>() += velocity * dt;
+//      Components::Transform copy = transform; // gathers the fields
+//
+// Every stream starts at a multiple of SPLIT_FIELD_ALIGNMENT, and `ComponentArray::get_field`
+// returns the field of all components of the array as a span, for SIMD kernels.
+// With ECS_ARCHETYPE_STORAGE components are stored whole, and references point into the component.
+
+template<auto ...Fields>
+struct ComponentFields {};
+
+template<typename T>
+struct component_fields {};
+
+template<typename T>
+concept SplitComponent = requires { typename component_fields<std::remove_cv_t<T>>::type; };
+
+// type of the field `Field` of a component of type T, const if T is const
+template<typename T, auto Field>
+using component_field_t = std::conditional_t<std::is_const_v<T>,
+    const std::remove_reference_t<decltype(std::declval<std::remove_cv_t<T>&>().*Field)>,
+    std::remove_reference_t<decltype(std::declval<std::remove_cv_t<T>&>().*Field)>>;
+
+// position of `Field` in `Fields`
+template<auto Field, auto ...Fields>
+constexpr std::size_t field_index() {
+    std::size_t index = 0;
+    bool found = false;
+
+    auto compare = [&]<auto Other>() {
+        if constexpr(std::is_same_v<decltype(Field), decltype(Other)>)
+            found = found || Field == Other;
+
+        if(!found)
+            index++;
+    };
+
+    (compare.template operator()<Fields>(), ...);
+
+    return index;
+}
+
+// SplitReference
+
+template<typename T, typename Fields = typename component_fields<std::remove_cv_t<T>>::type>
+class SplitReference;
+
+template<typename T, auto ...Fields>
+class SplitReference<T, ComponentFields<Fields...>> {
+public:
+    using value_type = std::remove_cv_t<T>;
+
+    SplitReference(component_field_t<T, Fields>* ...fields): m_fields{fields...} {}
+
+    // reference to a whole component
+    SplitReference(T& component): m_fields{&(component.*Fields)...} {}
+
+    // const reference from a mutable reference
+    SplitReference(const SplitReference<value_type>& other) requires std::is_const_v<T>:
+        m_fields{&other.template get<Fields>()...} {}
+
+    // assigning a reference would rebind it, assign a component value instead
+    SplitReference& operator=(const SplitReference&) = delete;
+
+    template<auto Field>
+    component_field_t<T, Field>& get() const {
+        static_assert(field_index<Field, Fields...>() < sizeof...(Fields), "Not a split field of the component");
+
+        return *std::get<field_index<Field, Fields...>()>(m_fields);
+    }
+
+    // gather the fields into a component
+    operator value_type() const {
+        value_type component;
+        ((component.*Fields = get<Fields>()), ...);
+
+        return component;
+    }
+
+    // scatter the component into the fields
+    const SplitReference& operator=(const value_type& component) const requires (!std::is_const_v<T>) {
+        ((get<Fields>() = component.*Fields), ...);
+
+        return *this;
+    }
+
+private:
+    std::tuple<component_field_t<T, Fields>*...> m_fields;
+};
+
+template<typename T>
+struct component_reference { using type = T&; };
+
+template<SplitComponent T>
+struct component_reference<T> { using type = SplitReference<T>; };
+
+template<typename T>
+using component_reference_t = typename component_reference<T>::type;
+
+// SplitFieldAllocator
+// aligns every field stream to SPLIT_FIELD_ALIGNMENT
+
+template<typename T>
+struct SplitFieldAllocator {
+    using value_type = T;
+
+    SplitFieldAllocator() = default;
+
+    template<typename U>
+    SplitFieldAllocator(const SplitFieldAllocator<U>&) {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{SPLIT_FIELD_ALIGNMENT}));
+    }
+
+    void deallocate(T* pointer, std::size_t) {
+        ::operator delete(pointer, std::align_val_t{SPLIT_FIELD_ALIGNMENT});
+    }
+
+    template<typename U>
+    bool operator==(const SplitFieldAllocator<U>&) const { return true; }
+};
+
+// SplitVector
+// vector of components stored as one stream per field, used by `ComponentArray` for split components
+
+template<typename T, typename Fields = typename component_fields<T>::type>
+class SplitVector;
+
+template<typename T, auto ...Fields>
+class SplitVector<T, ComponentFields<Fields...>> {
+    static_assert(sizeof...(Fields) > 0, "Split component without fields");
+
+public:
+    using reference = SplitReference<T>;
+
+    // bytes of the fields of one component, without padding
+    static constexpr std::size_t COMPONENT_BYTES = (sizeof(component_field_t<T, Fields>) + ...);
+
+    // the streams are saved as raw blocks (see `is_snapshot_component_v`)
+    static constexpr bool SNAPSHOT_FIELDS = ((std::is_trivially_copyable_v<component_field_t<T, Fields>>
+        && alignof(component_field_t<T, Fields>) <= SNAPSHOT_ALIGNMENT) && ...);
+
+    entity_count_size_type size() const { return std::get<0>(m_streams).size(); }
+    std::size_t capacity() const { return std::min({stream<Fields>().capacity()...}); }
+
+    reference operator[](std::size_t index) { return reference{&stream<Fields>()[index]...}; }
+    SplitReference<const T> operator[](std::size_t index) const { return SplitReference<const T>{&stream<Fields>()[index]...}; }
+
+    // the component is constructed whole, then its fields are moved into the streams
+    template<typename ...Args>
+    void emplace_back(Args&& ...args) { push_back(T(std::forward<Args>(args)...)); }
+    void push_back(const T& component) { (stream<Fields>().push_back(component.*Fields), ...); }
+    void push_back(T&& component) { (stream<Fields>().push_back(std::move(component.*Fields)), ...); }
+    void pop_back() { (stream<Fields>().pop_back(), ...); }
+    void resize(std::size_t count, const T& component) { (stream<Fields>().resize(count, component.*Fields), ...); }
+
+    void clear() { (stream<Fields>().clear(), ...); }
+    void reserve(std::size_t capacity) { (stream<Fields>().reserve(capacity), ...); }
+
+    void move_element(std::size_t from, std::size_t to) { ((stream<Fields>()[to] = std::move(stream<Fields>()[from])), ...); }
+    void swap_elements(std::size_t a, std::size_t b) { (std::swap(stream<Fields>()[a], stream<Fields>()[b]), ...); }
+
+    // the field of all components
+    template<auto Field>
+    std::span<component_field_t<T, Field>> get_field() { return {stream<Field>().data(), size()}; }
+
+    template<auto Field>
+    std::span<const component_field_t<T, Field>> get_field() const { return {stream<Field>().data(), size()}; }
+
+    // snapshots (see SceneSnapshot.hpp), one array per field. only if SNAPSHOT_FIELDS
+    void write_snapshot(SnapshotWriter& writer) const { (writer.write_array(stream<Fields>().data(), size()), ...); }
+    void read_snapshot(SnapshotReader& reader, entity_count_size_type count);
+    static void skip_snapshot(SnapshotReader& reader, entity_count_size_type count) { (reader.read_array<component_field_t<T, Fields>>(count), ...); }
+
+private:
+    template<auto Field>
+    using stream_type = std::vector<component_field_t<T, Field>, SplitFieldAllocator<component_field_t<T, Field>>>;
+
+    template<auto Field>
+    stream_type<Field>& stream() { return std::get<field_index<Field, Fields...>()>(m_streams); }
+
+    template<auto Field>
+    const stream_type<Field>& stream() const { return std::get<field_index<Field, Fields...>()>(m_streams); }
+
+private:
+    std::tuple<stream_type<Fields>...> m_streams;
+};
+
+template<typename T, auto ...Fields>
+void SplitVector<T, ComponentFields<Fields...>>::read_snapshot(SnapshotReader& reader, entity_count_size_type count) {
+    auto read_stream = [&]<auto Field>() {
+        const component_field_t<T, Field>* values = reader.read_array<component_field_t<T, Field>>(count);
+        stream<Field>().assign(values, values + count);
+    };
+
+    (read_stream.template operator()<Fields>(), ...);
+}
@@ -1,14 +1,38 @@
 #pragma once
 
+#include <engine/ecs/core/ComponentTypeId.hpp>
 #include <engine/ecs/core/Types.hpp>
 
 class Scene;
 
 // A system is any functionality that iterates upon a list of entities
 // with a certain signature of components.
+//
+// Systems declare the components they read and write in their constructor. `SystemManager`
+// runs systems which do not conflict at the same time, and conflicting systems in the order
+// they were registered. A system that declares nothing is ordered against all other systems.
 class System {
 public:
     System(Scene& scene) : m_scene{&scene} {}
+    virtual ~System() = default;
+
+    virtual void update(float dt) {}
+
+    Signature get_reads() const { return m_reads; }
+    Signature get_writes() const { return m_writes; }
+    bool declares_access() const { return m_reads.any() || m_writes.any(); }
+
+protected:
+    template<typename ...ComponentTypes>
+    void reads() { m_reads |= component_signature<ComponentTypes...>(); }
+
+    template<typename ...ComponentTypes>
+    void writes() { m_writes |= component_signature<ComponentTypes...>(); }
+
 protected:
     Scene* const m_scene;
-};
\ No newline at end of file
+
+private:
+    Signature m_reads;
+    Signature m_writes;
+};
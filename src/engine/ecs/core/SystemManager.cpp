@@ -1,3 +1,7 @@
+#include <atomic>
+#include <functional>
+#include <vector>
+
 #include <engine/ecs/core/SystemManager.hpp>
 
 #include <engine/ecs/core/Types.hpp>
@@ -8,4 +12,61 @@
 
 // void SystemManager::entity_signature_changed(Entity entity, Signature entity_new_signature) {
 //     // some logic can be used here, if systems want to react to changed entity signatures
-// }
\ No newline at end of file
+// }
+
+void SystemManager::update(float dt, ThreadPool& thread_pool) {
+    if(m_schedule_dirty)
+        build_schedule();
+
+    std::size_t count = m_registration_order.size();
+
+    // unfinished dependencies of each system
+    std::vector<std::atomic<std::size_t>> waiting(count);
+    for(std::size_t i = 0; i < count; i++)
+        waiting[i].store(m_schedule[i].dependency_count, std::memory_order_relaxed);
+
+    std::atomic<std::size_t> pending_tasks = 0;
+
+    std::function<void(std::size_t)> schedule = [&](std::size_t system) {
+        pending_tasks.fetch_add(1, std::memory_order_relaxed);
+        thread_pool.submit([&, system] {
+            m_registration_order[system]->update(dt);
+
+            // dependents are queued before this task is counted as done, so `pending_tasks`
+            // only reaches zero once every system has run
+            for(std::size_t dependent : m_schedule[system].dependents)
+                if(waiting[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    schedule(dependent);
+        }, pending_tasks);
+    };
+
+    for(std::size_t i = 0; i < count; i++)
+        if(m_schedule[i].dependency_count == 0)
+            schedule(i);
+
+    thread_pool.wait(pending_tasks);
+}
+
+bool SystemManager::conflicts(const System& a, const System& b) {
+    if(!a.declares_access() || !b.declares_access())
+        return true;
+
+    // write-write and read-write conflicts
+    return (a.get_writes() & (b.get_reads() | b.get_writes())).any() || (b.get_writes() & a.get_reads()).any();
+}
+
+void SystemManager::build_schedule() {
+    std::size_t count = m_registration_order.size();
+    m_schedule.assign(count, ScheduleNode{});
+
+    for(std::size_t later = 0; later < count; later++) {
+        for(std::size_t earlier = 0; earlier < later; earlier++) {
+            if(conflicts(*m_registration_order[earlier], *m_registration_order[later])) {
+                m_schedule[earlier].dependents.push_back(later);
+                m_schedule[later].dependency_count++;
+            }
+        }
+    }
+
+    m_schedule_dirty = false;
+}
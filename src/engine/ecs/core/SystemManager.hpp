@@ -4,10 +4,13 @@
 #include <memory>
 #include <unordered_map>
 #include <typeindex>
+#include <vector>
 
 #include <engine/ecs/core/System.hpp>
 #include <engine/ecs/core/Types.hpp>
 
+#include <engine/threading/ThreadPool.hpp>
+
 class Scene;
 
 class SystemManager {
@@ -15,13 +18,30 @@ public:
     // System Modifiers
     template<typename T, typename... Args>
     T& register_system(Scene& scene, Args&& ...args);
+
+    // update all systems. systems run on `thread_pool` as soon as the systems they depend on are done
+    void update(float dt, ThreadPool& thread_pool);
     
     // void entity_destroyed(Entity entity);
     // void entity_signature_changed(Entity entity, Signature entity_signature);
 
+private:
+    // a system depends on the earlier registered systems it conflicts with
+    struct ScheduleNode {
+        std::size_t dependency_count = 0;
+        std::vector<std::size_t> dependents;
+    };
+
+    static bool conflicts(const System& a, const System& b);
+    void build_schedule();
+
 private:
     system_count_size_type m_system_count = 0;
     std::unordered_map<std::type_index, std::unique_ptr<System>> m_systems;
+
+    std::vector<System*> m_registration_order;
+    std::vector<ScheduleNode> m_schedule; // dependency graph, indexed like `m_registration_order`
+    bool m_schedule_dirty = true;
 };
 
 template<typename T, typename... Args>
@@ -36,6 +56,8 @@ T& SystemManager::register_system(Scene& scene, Args&& ...args) {
     auto it = m_systems.emplace(type, std::make_unique<T>(scene, std::forward<Args>(args)...)).first; // initialize system with scene
 
     m_system_count++;
+    m_registration_order.push_back(it->second.get());
+    m_schedule_dirty = true;
 
     return *static_cast<T*>(it->second.get());
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <bitset>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 
@@ -9,25 +10,40 @@
 using entity_count_size_type = std::uint32_t;
 // using entity_count_signed_size_type = std::int64_t;
 using Entity = entity_count_size_type;
-const Entity MAX_ENTITIES = 100;
-const Entity MAX_ENTITIES_AFTER_CAMERA = MAX_ENTITIES - 1; // after user creates a `Camera` entity is created for RenderSystem
 
-const entity_count_size_type NO_SIGNATURE_MARKER = MAX_ENTITIES;
-const entity_count_size_type NO_COMPONENT_MARKER = MAX_ENTITIES; // entities: 0 to MAX_ENTITIES-1
-                                                                 // valid as long as MAX_ENTITIES is not UINT32_MAX
+// entity capacity is set at runtime on `Scene`, this is only the default
+const Entity DEFAULT_MAX_ENTITIES = 1 << 20;
+
+// sparse arrays store dense indices, the largest value is reserved as the "no index" marker.
+// entities: 0 to (scene capacity - 1), so the capacity can never exceed NO_INDEX_MARKER
+const entity_count_size_type NO_INDEX_MARKER = std::numeric_limits<entity_count_size_type>::max();
+const entity_count_size_type NO_SIGNATURE_MARKER = NO_INDEX_MARKER;
+const entity_count_size_type NO_COMPONENT_MARKER = NO_INDEX_MARKER;
 
 using component_count_size_type = std::uint16_t; // MAX_COMPONENTS will fit within 16 bits
 using ComponentType = component_count_size_type; // MAX_COMPONENTS will fit within 16 bits
-const ComponentType MAX_COMPONENTS = 32;
+const ComponentType MAX_COMPONENTS = 64; // component type ids are process wide (see ComponentTypeId.hpp)
 
 using system_count_size_type = std::uint16_t; // max number of systems will fit within 16 bits
 const system_count_size_type MAX_SYSTEMS = 32;
 
 using Signature = std::bitset<MAX_COMPONENTS>;
 
+// size of a chunk of the archetype storage backend (ECS_ARCHETYPE_STORAGE)
+const std::size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+
+// size of a block of components with ECS_CHUNKED_COMPONENT_STORAGE (see BlockVector.hpp)
+const std::size_t COMPONENT_BLOCK_SIZE = 16 * 1024;
+
+// alignment of the field streams of split components (see SplitComponent.hpp)
+const std::size_t SPLIT_FIELD_ALIGNMENT = 64;
+
 // Events
 using EventId = std::uint32_t;
 using ParamId = std::uint32_t;
 
+// records in the ring buffer of queued events (see EventQueue.hpp)
+const std::size_t EVENT_QUEUE_CAPACITY = 4096;
+
 #define METHOD_LISTENER(EventType, Listener) EventType, std::bind(&Listener, this, std::placeholders::_1)
 #define FUNCTION_LISTENER(EventType, Listener) EventType, std::bind(&Listener, std::placeholders::_1)
\ No newline at end of file
@@ -16,15 +16,22 @@
 
 CameraControlSystem::CameraControlSystem(Scene& scene, InputHandler& input_handler): 
     System{scene}, m_input_handler{&input_handler} {
-    m_scene->add_event_listener(METHOD_LISTENER(Events::Input::MOUSE, CameraControlSystem::mouse_listener));
-    m_scene->add_event_listener(METHOD_LISTENER(Events::Input::SCROLL, CameraControlSystem::scroll_listener));
+    writes<Components::Camera, Components::Transform>();
+
+    m_scene->add_event_listener<&CameraControlSystem::mouse_listener>(this);
+    m_scene->add_event_listener<&CameraControlSystem::scroll_listener>(this);
 }
 
 void CameraControlSystem::update(float dt) {
-    if(!WindowManager::is_window_focused())
+    if(!WindowManager::is_window_focused()) {
+        m_camera_rotation = {};
+        m_camera_zoom = {};
+
         return;
+    }
 
-    for (Entity entity : SceneView<Components::Camera, Components::Transform>(*m_scene)) {
+    SceneView<Components::Camera, Components::Transform>(*m_scene).each(
+        [&](Entity entity, Components::Camera&, component_reference_t<Components::Transform>) {
         CameraWrapper camera_wrapper{*m_scene, entity};
         float cam_offset = dt * GraphicsConfig::Camera::CAMERA_SPEED;
 
@@ -48,30 +55,28 @@ void CameraControlSystem::update(float dt) {
         // m_input_handler->react_key_noprocess(GLFW_KEY_W, []() {})
 
         // rotate camera
-        if(m_camera_rotation.b_rotate) {
-            camera_wrapper.rotate_camera(m_camera_rotation.rotation.x_offset, m_camera_rotation.rotation.y_offset);
-            m_camera_rotation.b_rotate = false;
-        }
+        if(m_camera_rotation.b_rotate)
+            camera_wrapper.rotate_camera(m_camera_rotation.x_offset, m_camera_rotation.y_offset);
 
         // zoom camera
-        if(m_camera_zoom.b_zoom) {
+        if(m_camera_zoom.b_zoom)
             camera_wrapper.zoom_camera(m_camera_zoom.zoom_offset);
-            m_camera_zoom.b_zoom = false;
-        }
-    }
+    });
+
+    // the offsets are applied to every camera
+    m_camera_rotation = {};
+    m_camera_zoom = {};
 }
 
-void CameraControlSystem::mouse_listener(Event& event) {
-    m_camera_rotation.rotation = event.get_param<InputHandler::MouseData>(Events::Input::Mouse::MOUSE_DATA);
-    m_camera_rotation.rotation.x_offset *= GraphicsConfig::Camera::CAMERA_MOUSE_SENSITIVITY;
-    m_camera_rotation.rotation.y_offset *= GraphicsConfig::Camera::CAMERA_MOUSE_SENSITIVITY;
+void CameraControlSystem::mouse_listener(const Events::Input::MouseMoved& event) {
+    m_camera_rotation.x_offset += event.x_offset * GraphicsConfig::Camera::CAMERA_MOUSE_SENSITIVITY;
+    m_camera_rotation.y_offset += event.y_offset * GraphicsConfig::Camera::CAMERA_MOUSE_SENSITIVITY;
 
     m_camera_rotation.b_rotate = true;
 }
 
-void CameraControlSystem::scroll_listener(Event& event) {
-    InputHandler::ScrollData scroll_data = event.get_param<InputHandler::ScrollData>(Events::Input::Scroll::SCROLL_DATA);
-    m_camera_zoom.zoom_offset = scroll_data.y_offset * GraphicsConfig::Camera::CAMERA_SCROLL_SENSITIVITY;
+void CameraControlSystem::scroll_listener(const Events::Input::Scrolled& event) {
+    m_camera_zoom.zoom_offset += event.y_offset * GraphicsConfig::Camera::CAMERA_SCROLL_SENSITIVITY;
     
     m_camera_zoom.b_zoom = true;
 }
\ No newline at end of file
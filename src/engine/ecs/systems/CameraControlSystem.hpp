@@ -6,24 +6,32 @@
 
 #include <engine/input/InputHandler.hpp>
 
+#include <engine/config/Events.hpp>
+
+// CameraControlSystem
+// Moves the cameras with the keyboard, and rotates and zooms them with the mouse. It is not registered
+// with the scene: it runs once per rendered frame, outside of the fixed timestep (see Application::run),
+// so that the camera moves at the frame rate.
 class CameraControlSystem : public System {
 public:
     CameraControlSystem(Scene& scene, InputHandler& input_handler);
-    void update(float dt);
+    void update(float dt) override;
 
 private:
+    // offsets of all events since the last update
     struct CameraRotateData {
         bool b_rotate = false;
-        InputHandler::MouseData rotation;
+        double x_offset = 0.0;
+        double y_offset = 0.0;
     } m_camera_rotation;
     
     struct CameraZoomData {
         bool b_zoom = false;
-        double zoom_offset;
+        double zoom_offset = 0.0;
     } m_camera_zoom;
 
-    void mouse_listener(Event& event);
-    void scroll_listener(Event& event);
+    void mouse_listener(const Events::Input::MouseMoved& event);
+    void scroll_listener(const Events::Input::Scrolled& event);
 
     InputHandler* const m_input_handler;
 };
\ No newline at end of file
@@ -7,25 +7,27 @@
 #include <engine/ecs/components/RigidBody.hpp>
 #include <engine/ecs/components/Transform.hpp>
 
+PhysicsSystem::PhysicsSystem(Scene& scene): System{scene} {
+    reads<Components::Gravity>();
+    writes<Components::RigidBody, Components::Transform>();
+}
+
 void PhysicsSystem::init() {}
 
 void PhysicsSystem::update(float dt)
 {
-    for (const auto& entity : SceneView<Components::RigidBody, Components::Transform, Components::Gravity>(*m_scene))
-    {
-        auto& rigid_body = m_scene->get_component<Components::RigidBody>(entity);
-        auto& transform = m_scene->get_component<Components::Transform>(entity);
-
-        // forces
-        const auto& gravity = m_scene->get_component<Components::Gravity>(entity);
+    SceneView<Components::RigidBody, Components::Transform, const Components::Gravity>(*m_scene).parallel_each(
+        [dt](Entity entity, Components::RigidBody& rigid_body, component_reference_t<Components::Transform> transform, const Components::Gravity& gravity) {
+        // only the position stream of the transforms is loaded
+        glm::vec3& position = transform.get<&Components::Transform::position>();
 
         // bounce of "ground"
-        if(transform.position.y <= -100) {
+        if(position.y <= -100) {
             rigid_body.velocity.y *= -1;
         }
 
         // update quantities
-        transform.position += rigid_body.velocity * dt;
+        position += rigid_body.velocity * dt;
         rigid_body.velocity += gravity.force * dt;
-    }
+    });
 }
@@ -4,8 +4,8 @@
 
 class PhysicsSystem : public System {
 public:
-    PhysicsSystem(Scene& scene): System{scene} {}
+    PhysicsSystem(Scene& scene);
 
     void init();
-    void update(float dt);
+    void update(float dt) override;
 };
@@ -8,7 +8,7 @@ public:
     PlayerControlSystem(Scene& scene): System(scene) {}
     void init();
 
-    void update(float dt);
+    void update(float dt) override;
 
 private:
     void input_listener(Event& event);
@@ -8,11 +8,13 @@
 #include <engine/ecs/core/Event.hpp>
 #include <engine/ecs/core/Scene.hpp>
 #include <engine/ecs/core/SceneView.hpp>
+#include <engine/ecs/core/Group.hpp>
 
 #include <engine/ecs/components/Cubemap.hpp>
 #include <engine/ecs/components/Camera.hpp>
 #include <engine/ecs/components/Renderable.hpp>
 #include <engine/ecs/components/Transform.hpp>
+#include <engine/ecs/components/WorldTransform.hpp>
 #include <engine/ecs/components/Model.hpp>
 #include <engine/ecs/components/PointLight.hpp>
 #include <engine/ecs/components/DirectionalLight.hpp>
@@ -31,14 +33,17 @@ void RenderSystem::gl_init_callback(Event& event) {
 RenderSystem::RenderSystem(Scene& scene, Entity camera, GUIState& gui_state): 
     System{scene},
     m_model_manager(m_texture_manager), m_camera_wrapper(scene, camera), m_gui_state{&gui_state} {
+    // sorting models reorders the arrays of the model group.
+    // lights are placed from the GUI state at extraction, outside of the scene update
+    writes<Components::Renderable, Components::Model, Components::WorldTransform>();
+
     // setup opengl properties
     glClearColor(GraphicsConfig::GL_CLEAR_COLOR.r, GraphicsConfig::GL_CLEAR_COLOR.g,
             GraphicsConfig::GL_CLEAR_COLOR.b, GraphicsConfig::GL_CLEAR_COLOR.a);
     glEnable(GL_DEPTH_TEST);
 
     // add window resize listener
-    // todo: rename event to Events::Window::FRAMEBUFFER_RESIZED
-    m_scene->add_event_listener(METHOD_LISTENER(Events::Window::RESIZED, RenderSystem::window_size_listener));
+    m_scene->add_event_listener<&RenderSystem::window_size_listener>(this);
 
     // initialize shaders
     m_model_shader = make_shader("shader_pbr.vs", "shader_pbr.fs");
@@ -54,8 +59,8 @@ RenderSystem::RenderSystem(Scene& scene, Entity camera, GUIState& gui_state):
 }
 
 void RenderSystem::init_framebuffer_size(int win_framebuffer_width, int win_framebuffer_height) {
-    m_win_framebuffer_width = win_framebuffer_width;
-    m_win_framebuffer_height = win_framebuffer_height;
+    m_win_framebuffer_width = m_resized_framebuffer_width = win_framebuffer_width;
+    m_win_framebuffer_height = m_resized_framebuffer_height = win_framebuffer_height;
 
     // initialize hdr rendering
     init_hdr_fbo();
@@ -69,13 +74,13 @@ cubemaps_interface_type RenderSystem::load_cubemaps(std::unordered_map<std::stri
     return m_texture_manager.load_cubemaps(cubemaps);
 }
 
-void RenderSystem::draw_cubemap(unsigned int cubemap_id) {
-    m_texture_manager.draw_cubemap(cubemap_id, m_cubemap_shader, m_camera_wrapper);
+void RenderSystem::draw_cubemap(unsigned int cubemap_id, const GraphicsHelper::MVP& mvp) {
+    m_texture_manager.draw_cubemap(cubemap_id, m_cubemap_shader, mvp);
 }
 
-void RenderSystem::buffer_camera_data() {
+void RenderSystem::buffer_camera_data(const RenderState& state) {
     m_model_shader->activate();
-    m_shader_uniform_blocks.camera.view_pos = glm::vec4(m_camera_wrapper.get_transform_component().position, 0.0);
+    m_shader_uniform_blocks.camera.view_pos = glm::vec4(state.camera_position, 0.0);
     glBindBuffer(GL_UNIFORM_BUFFER, m_shader_uniform_blocks.ubo_camera);
     glBufferSubData(GL_UNIFORM_BUFFER, ShaderUniformBlocks::UBLOCK_OFFSET_BEGIN, sizeof(m_shader_uniform_blocks.camera), &m_shader_uniform_blocks.camera);
 }
@@ -89,90 +94,211 @@ void RenderSystem::buffer_gui_data() {
     glBufferSubData(GL_UNIFORM_BUFFER, ShaderUniformBlocks::UBLOCK_OFFSET_BEGIN, sizeof(m_shader_uniform_blocks.gui_state), &m_shader_uniform_blocks.gui_state);
 }
 
-void RenderSystem::buffer_matrices() {
-    m_shader_uniform_blocks.matrices.view = m_camera_wrapper.get_view_matrix();
-    m_shader_uniform_blocks.matrices.projection = m_camera_wrapper.get_projection_matrix();
+void RenderSystem::buffer_matrices(const RenderState& state) {
+    m_shader_uniform_blocks.matrices.view = state.view;
+    m_shader_uniform_blocks.matrices.projection = state.projection;
 
     glBindBuffer(GL_UNIFORM_BUFFER, m_shader_uniform_blocks.ubo_matrices);
     glBufferSubData(GL_UNIFORM_BUFFER, ShaderUniformBlocks::UBLOCK_OFFSET_BEGIN, sizeof(m_shader_uniform_blocks.matrices), &m_shader_uniform_blocks.matrices);
     // glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ShaderNormalData::ub_matrices, normal_matrix), sizeof(glm::mat3), &shader_normal_data.matrices.normal_matrix);
 }
 
-void RenderSystem::render_point_lights() {
-    int i_lights = 0;
-    
+void RenderSystem::sort_models() {
+    change_tick_type since = m_sorted_models_tick;
+    m_sorted_models_tick = m_scene->advance_change_tick();
+
+    SceneView<const Components::Model> changed_models(*m_scene, SceneViewChanged<Components::Model>{since});
+    entity_count_size_type count = m_scene->count_components<Components::Model>();
+
+    if(changed_models.begin() == changed_models.end() && count == m_sorted_models_count)
+        return;
+
+    m_scene->sort<Components::Model>([](const Components::Model& a, const Components::Model& b) {
+        return a.model_id < b.model_id;
+    });
+
+    m_sorted_models_count = count;
+}
+
+void RenderSystem::extract_render_state(float interpolation) {
+    apply_gui_lights();
+
+    RenderState& state = m_render_states[1 - m_front_state];
+    state.interpolation = interpolation;
+
+    state.camera_position = m_camera_wrapper.get_transform_component().position;
+    state.view = m_camera_wrapper.get_view_matrix();
+    state.projection = m_camera_wrapper.get_projection_matrix();
+
+    state.framebuffer_width = m_resized_framebuffer_width;
+    state.framebuffer_height = m_resized_framebuffer_height;
+
+    extract_lights(state);
+    extract_models(state);
+
+    state.cubemaps.clear();
+    SceneView<const Components::Renderable, const Components::Cubemap>(*m_scene).each(
+        [&](Entity entity, const Components::Renderable&, const Components::Cubemap& cubemap) {
+        state.cubemaps.push_back(cubemap.id);
+    });
+
+    m_front_state = 1 - m_front_state;
+}
+
+void RenderSystem::apply_gui_lights() {
+    // control position of 0th light
     for(const auto& entity : SceneView<Components::PointLight, Components::Transform>(*m_scene)) {
-        glm::vec3 light_color = m_scene->get_component<Components::PointLight>(entity).light_color;
-        auto& light_transform = m_scene->get_component<Components::Transform>(entity);
-        
-        // control position of 0th light
-        if(i_lights == 0) {
-            light_transform.position = glm::vec3(m_gui_state->light0_pos[0], m_gui_state->light0_pos[1], m_gui_state->light0_pos[2]);
-        }
+        m_scene->get_mutable_component<Components::Transform>(entity).get<&Components::Transform::position>() = glm::vec3(m_gui_state->light0_pos[0], m_gui_state->light0_pos[1], m_gui_state->light0_pos[2]);
+        break;
+    }
+
+    for(const auto& entity : SceneView<Components::DirectionalLight, Components::Transform>(*m_scene)) {
+        m_scene->get_mutable_component<Components::Transform>(entity).get<&Components::Transform::position>() = glm::vec3(m_gui_state->dir_light0_pos[0], m_gui_state->dir_light0_pos[1], m_gui_state->dir_light0_pos[2]);
+        m_scene->get_mutable_component<Components::DirectionalLight>(entity).direction = glm::vec3(m_gui_state->dir_light0_direction[0], m_gui_state->dir_light0_direction[1], m_gui_state->dir_light0_direction[2]);
+        break;
+    }
+}
+
+void RenderSystem::extract_lights(RenderState& state) {
+    // lights are few, they are copied every frame
+    state.point_lights.clear();
+    SceneView<const Components::PointLight, const Components::WorldTransform>(*m_scene).each(
+        [&](Entity entity, const Components::PointLight& light, const Components::WorldTransform& world_transform) {
+        state.point_lights.push_back({world_transform.matrix, glm::vec3(world_transform.matrix[3]), light.light_color});
+    });
+
+    state.dir_lights.clear();
+    SceneView<const Components::DirectionalLight, const Components::WorldTransform>(*m_scene).each(
+        [&](Entity entity, const Components::DirectionalLight& light, const Components::WorldTransform& world_transform) {
+        state.dir_lights.push_back({world_transform.matrix, glm::vec3(world_transform.matrix[3]), light.direction, light.light_color});
+    });
+}
+
+void RenderSystem::extract_models(RenderState& state) {
+    change_tick_type since = state.extracted_tick;
+    state.extracted_tick = m_scene->advance_change_tick();
+
+    Group<const Components::Renderable, const Components::Model, const Components::WorldTransform> models(*m_scene);
+    entity_count_size_type model_count = m_scene->count_components<Components::Model>();
+
+    // adding, removing or changing models changes the set of models or their draw order (see `sort_models`).
+    // `Renderable` is a tag without change ticks, so its additions are caught by the counts
+    SceneView<const Components::Model> changed_models(*m_scene, SceneViewChanged<Components::Model>{since});
+    SceneView<const Components::WorldTransform> added_world_transforms(*m_scene, SceneViewAdded<Components::WorldTransform>{since});
+
+    bool models_changed = models.size() != state.models.size()
+        || model_count != state.extracted_model_count
+        || m_scene->count_components<Components::Renderable>() != state.extracted_renderable_count
+        || changed_models.begin() != changed_models.end()
+        || added_world_transforms.begin() != added_world_transforms.end();
+
+    if(!models_changed) {
+        // only copy the matrices recomputed since the last extraction
+        SceneView<const Components::Renderable, const Components::Model, const Components::WorldTransform>(*m_scene, SceneViewChanged<Components::WorldTransform>{since}).each(
+            [&](Entity entity, const Components::Renderable&, const Components::Model&, const Components::WorldTransform& world_transform) {
+            entity_count_size_type index = state.model_indices.get(entity);
+
+            if(index == NO_INDEX_MARKER) {
+                models_changed = true; // renderable moved to another entity
+                return;
+            }
+
+            state.models[index].matrix = world_transform.matrix;
+            state.models[index].normal_matrix = world_transform.normal_matrix;
+            state.models[index].previous_matrix = world_transform.previous_matrix;
+        });
+
+        if(!models_changed)
+            return;
+    }
 
-        m_light_renderer.draw_light_cube(light_transform, m_camera_wrapper, light_color);
+    for(const RenderState::ModelInstance& model : state.models)
+        state.model_indices.reset(model.entity);
+
+    state.models.clear();
+    state.extracted_model_count = model_count;
+    state.extracted_renderable_count = m_scene->count_components<Components::Renderable>();
+
+    models.each(
+        [&](Entity entity, const Components::Renderable&, const Components::Model& object_model, const Components::WorldTransform& world_transform) {
+        state.model_indices.set(entity, state.models.size());
+        state.models.push_back({entity, object_model.model_id, world_transform.matrix, world_transform.normal_matrix, world_transform.previous_matrix});
+    });
+}
+
+void RenderSystem::render_point_lights(const RenderState& state) {
+    GraphicsHelper::MVP mvp;
+    mvp.view = state.view;
+    mvp.projection = state.projection;
+
+    for(std::size_t i_lights = 0; i_lights < state.point_lights.size(); i_lights++) {
+        const RenderState::PointLight& light = state.point_lights[i_lights];
+
+        m_light_renderer.draw_light_cube(light.matrix, mvp, light.color);
         
         m_model_shader->activate();
         
         // set lights for model shader (tbd: this will be changed to ssbo for lights)
-        m_model_shader->set_uniform<glm::vec3>("u_point_lights[" + std::to_string(i_lights) + "].position", light_transform.position);
-        m_model_shader->set_uniform<glm::vec3>("u_point_lights[" + std::to_string(i_lights) + "].color", light_color);
-        
-        i_lights++;
+        m_model_shader->set_uniform<glm::vec3>("u_point_lights[" + std::to_string(i_lights) + "].position", light.position);
+        m_model_shader->set_uniform<glm::vec3>("u_point_lights[" + std::to_string(i_lights) + "].color", light.color);
     }
 }
 
-void RenderSystem::render_dir_lights() {
-    int i_lights = 0;
-    
-    for(const auto& entity : SceneView<Components::DirectionalLight, Components::Transform>(*m_scene)) {
-        auto& light = m_scene->get_component<Components::DirectionalLight>(entity);
-        auto& light_transform = m_scene->get_component<Components::Transform>(entity);
+void RenderSystem::render_dir_lights(const RenderState& state) {
+    GraphicsHelper::MVP mvp;
+    mvp.view = state.view;
+    mvp.projection = state.projection;
 
-        // control position of 0th light
-        if(i_lights == 0) {
-            light_transform.position = glm::vec3(m_gui_state->dir_light0_pos[0], m_gui_state->dir_light0_pos[1], m_gui_state->dir_light0_pos[2]);
-            light.direction = glm::vec3(m_gui_state->dir_light0_direction[0], m_gui_state->dir_light0_direction[1], m_gui_state->dir_light0_direction[2]);
-        }
+    for(std::size_t i_lights = 0; i_lights < state.dir_lights.size(); i_lights++) {
+        const RenderState::DirectionalLight& light = state.dir_lights[i_lights];
 
         // position of directional light is used for shadow mapping
-        m_light_renderer.draw_light_cube(light_transform, m_camera_wrapper, light.light_color);
+        m_light_renderer.draw_light_cube(light.matrix, mvp, light.color);
 
         m_model_shader->activate();
-        m_model_shader->set_uniform<glm::vec3>("u_dir_lights[" + std::to_string(i_lights) + "].position", light_transform.position);
+        m_model_shader->set_uniform<glm::vec3>("u_dir_lights[" + std::to_string(i_lights) + "].position", light.position);
         m_model_shader->set_uniform<glm::vec3>("u_dir_lights[" + std::to_string(i_lights) + "].direction", light.direction);
-        m_model_shader->set_uniform<glm::vec3>("u_dir_lights[" + std::to_string(i_lights) + "].color", light.light_color);
-
-        i_lights++;
+        m_model_shader->set_uniform<glm::vec3>("u_dir_lights[" + std::to_string(i_lights) + "].color", light.color);
     }
 }
 
-void RenderSystem::render_models(const std::unique_ptr<Shader>& shader) {
+void RenderSystem::render_models(const std::unique_ptr<Shader>& shader, const RenderState& state) {
     shader->activate();
 
     GraphicsHelper::MVP mvp;
-    mvp.view = m_camera_wrapper.get_view_matrix();
-    mvp.projection = m_camera_wrapper.get_projection_matrix();
+    mvp.view = state.view;
+    mvp.projection = state.projection;
 
     // draw models
-    for(const auto& entity : SceneView<Components::Renderable, Components::Model, Components::Transform>(*m_scene)) {
-        const auto& transform = m_scene->get_component<Components::Transform>(entity);
-        const auto& object_model = m_scene->get_component<Components::Model>(entity);
-
-        m_model_manager.draw_model(shader, object_model.model_id, transform, mvp);
-    }
+    for(const RenderState::ModelInstance& model : state.models)
+        m_model_manager.draw_model(shader, model.model_id, model.interpolated_matrix(state.interpolation), model.normal_matrix, mvp);
 }
 
-void RenderSystem::render_cubemaps() {
-    for(const auto& entity : SceneView<Components::Renderable, Components::Cubemap>(*m_scene))
-        draw_cubemap(m_scene->get_component<Components::Cubemap>(entity).id);
+void RenderSystem::render_cubemaps(const RenderState& state) {
+    GraphicsHelper::MVP mvp;
+    mvp.view = state.view;
+    mvp.projection = state.projection;
+
+    for(unsigned int cubemap_id : state.cubemaps)
+        draw_cubemap(cubemap_id, mvp);
 }
 
 void RenderSystem::update(float dt) {
-    // TODO: create a method to update render state before rendering. 
-    // ex: m_gui_state->light0_pos should change `Transform` for first light
-    // update_render_state_gui();
+    sort_models();
+}
+
+void RenderSystem::render() {
     // TODO: optimize. without any models: toggling rendersystem->update() causes drop 1700fps -> 700fps
+    const RenderState& state = m_render_states[m_front_state];
+
+    // resize viewport to match new window dimensions
+    if(state.framebuffer_width != m_win_framebuffer_width || state.framebuffer_height != m_win_framebuffer_height) {
+        m_win_framebuffer_width = state.framebuffer_width;
+        m_win_framebuffer_height = state.framebuffer_height;
+
+        glViewport(0, 0, m_win_framebuffer_width, m_win_framebuffer_height);
+        resize_hdr_attachments();
+    }
 
     // clear screen and buffers
     glClearColor(GraphicsConfig::GL_CLEAR_COLOR.r, GraphicsConfig::GL_CLEAR_COLOR.g,
@@ -182,9 +308,9 @@ void RenderSystem::update(float dt) {
     // set OpenGL parameters
     glEnable(GL_DEPTH_TEST);
 
-    buffer_camera_data();
+    buffer_camera_data(state);
     buffer_gui_data();
-    buffer_matrices();
+    buffer_matrices(state);
 
     // 0. render to shadow depth map FBO
     glEnable(GL_CULL_FACE);
@@ -196,13 +322,11 @@ void RenderSystem::update(float dt) {
     float light_near_plane = 1.0f, light_far_plane = ortho_bound;
     light_projection = glm::ortho(-ortho_bound, ortho_bound, -ortho_bound, ortho_bound, light_near_plane, light_far_plane);
 
-    render_dir_lights();
+    assert(!state.dir_lights.empty() && "Shadow mapping requires a directional light");
 
-    auto dir_light0_entity = *(SceneView<Components::DirectionalLight, Components::Transform>(*m_scene).begin());
-    auto dir_light0_transform = m_scene->get_component<Components::Transform>(dir_light0_entity);
-    auto dir_light0_light = m_scene->get_component<Components::DirectionalLight>(dir_light0_entity);
-    // light_view = glm::lookAt(dir_light0_transform.position, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    light_view = glm::lookAt(dir_light0_transform.position, dir_light0_transform.position - dir_light0_light.direction, glm::vec3(0.0f, 1.0f, 0.0f));
+    const RenderState::DirectionalLight& dir_light0 = state.dir_lights.front();
+    // light_view = glm::lookAt(dir_light0.position, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    light_view = glm::lookAt(dir_light0.position, dir_light0.position - dir_light0.direction, glm::vec3(0.0f, 1.0f, 0.0f));
 
     light_space_matrix = light_projection * light_view;
 
@@ -214,7 +338,7 @@ void RenderSystem::update(float dt) {
     glBindFramebuffer(GL_FRAMEBUFFER, m_shadow_depth_map_fbo);
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    render_models(m_shadow_depth_shader);
+    render_models(m_shadow_depth_shader, state);
 
     // reset viewport
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // imp!!
@@ -240,12 +364,12 @@ void RenderSystem::update(float dt) {
     glActiveTexture(GL_TEXTURE0 + shadow_map_tex_unit);
     glBindTexture(GL_TEXTURE_2D, m_depth_map_tex);
 
-    render_point_lights();
-    render_dir_lights();
-    render_models(m_model_shader);
+    render_point_lights(state);
+    render_dir_lights(state);
+    render_models(m_model_shader, state);
 
     glDisable(GL_CULL_FACE);
-    render_cubemaps();
+    render_cubemaps(state);
 
     // 2. render hdr framebuffer to 2D quad and tonemap hdr colors on default framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -280,20 +404,16 @@ std::unique_ptr<Shader> RenderSystem::make_shader(std::string const &vertex_path
         std::string(FS_SHADERS_DIR) + fragment_path, geometry_path));
 }
 
-void RenderSystem::window_size_listener(Event &event) {
-    m_win_framebuffer_width = event.get_param<int>(Events::Window::Resized::WIDTH);
-    m_win_framebuffer_height = event.get_param<int>(Events::Window::Resized::HEIGHT);
+void RenderSystem::window_size_listener(const Events::Window::FramebufferResized& event) {
+    // the viewport is resized by `render` once the new size has been extracted
+    m_resized_framebuffer_width = event.width;
+    m_resized_framebuffer_height = event.height;
     // ENGINE_LOG(window_width << " " << window_height);
-    
-    // resize viewport to match new window dimensions
-    glViewport(0, 0, m_win_framebuffer_width, m_win_framebuffer_height);
-
-    resize_hdr_attachments();
 
     // resize view size for all cameras
     for(auto& entity : SceneView<Components::Camera, Components::Transform>(*m_scene)) {
         CameraWrapper camera_wrapper{*m_scene, entity};
-        camera_wrapper.resize_view(m_win_framebuffer_width, m_win_framebuffer_height);
+        camera_wrapper.resize_view(m_resized_framebuffer_width, m_resized_framebuffer_height);
     }
 }
 
@@ -1,47 +1,79 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <vector>
 
+#include <glm/glm.hpp>
+
+#include <engine/ecs/core/ChangeTicks.hpp>
 #include <engine/ecs/core/System.hpp>
 #include <engine/ecs/core/Event.hpp>
 
+#include <engine/ecs/components/Transform.hpp>
+
 #include <engine/graphics/ModelManager.hpp>
 #include <engine/graphics/TextureManager.hpp>
 #include <engine/graphics/CameraWrapper.hpp>
 #include <engine/graphics/Shader.hpp>
 #include <engine/graphics/objects/GraphicsObjects.hpp>
 #include <engine/graphics/LightRenderer.hpp>
+#include <engine/graphics/RenderState.hpp>
+#include <engine/graphics/lib/GraphicsHelper.hpp>
 
 #include <engine/gui/GUIState.hpp>
 
+#include <engine/config/Events.hpp>
+
 #include <engine/shaders/interface/ShaderUniformBlocks.hpp>
 
+// RenderSystem
+// Rendering is split so that a frame can be rendered while the next one is simulated:
+//  1. `update` prepares the render relevant components (world matrices, draw order) as part of the
+//     scene update. it makes no OpenGL calls and may run on any thread
+//  2. `extract_render_state` copies them into the back `RenderState` and makes it the front state.
+//     called between scene updates, on the thread owning the GUI state. `interpolation` is the fraction of
+//     a tick the models are drawn past their previous tick (see `Application::run`)
+//  3. `render` draws the front state on the OpenGL thread, without touching the scene
+// The two render states are extracted into alternately, each copying the changes since its own last extraction.
 class RenderSystem : public System {
 public:
     RenderSystem(Scene& scene, Entity camera, GUIState& gui_state);
     void init_framebuffer_size(int win_framebuffer_width, int win_framebuffer_height);
     // void init();
 
-    void update(float dt);
+    void update(float dt) override;
+
+    void extract_render_state(float interpolation = 1.0f);
+    void render();
 
     void set_uniforms_pre_rendering();
     void set_camera(Entity camera) { m_camera_wrapper = CameraWrapper{*m_scene, camera}; }
 
     models_interface_type load_models(std::unordered_map<std::string, std::string> models);
     cubemaps_interface_type load_cubemaps(std::unordered_map<std::string, CubemapFaces> cubemaps);
-    void draw_cubemap(unsigned int cubemap_id);
+    void draw_cubemap(unsigned int cubemap_id, const GraphicsHelper::MVP& mvp);
 
-    void buffer_camera_data();
+    void buffer_camera_data(const RenderState& state);
     void buffer_gui_data();
-    void buffer_matrices();
+    void buffer_matrices(const RenderState& state);
     
     // void set_dir_lights();
     // void set_point_lights();
 
-    void render_point_lights();
-    void render_dir_lights();
-    void render_models(const std::unique_ptr<Shader>& shader);
-    void render_cubemaps();
+    // simulation
+    void sort_models();
+
+    // extraction
+    void apply_gui_lights();
+    void extract_lights(RenderState& state);
+    void extract_models(RenderState& state);
+
+    // rendering
+    void render_point_lights(const RenderState& state);
+    void render_dir_lights(const RenderState& state);
+    void render_models(const std::unique_ptr<Shader>& shader, const RenderState& state);
+    void render_cubemaps(const RenderState& state);
 
     // callback methods for when opengl context has been created
     static void gl_init_callback(Event& event);
@@ -58,9 +90,18 @@ private:
 
     GUIState* const m_gui_state;
 
+    // models are kept sorted by model id, so that consecutive draws share buffers and textures.
+    // they are sorted again when models were added or changed since this tick, or removed
+    change_tick_type m_sorted_models_tick = 0;
+    entity_count_size_type m_sorted_models_count = 0;
+
+    std::array<RenderState, 2> m_render_states;
+    std::size_t m_front_state = 0; // index of the state drawn by `render`
+
     ShaderUniformBlocks m_shader_uniform_blocks;
 
-    unsigned int m_win_framebuffer_width, m_win_framebuffer_height;
+    unsigned int m_win_framebuffer_width, m_win_framebuffer_height; // size of the OpenGL framebuffers
+    unsigned int m_resized_framebuffer_width, m_resized_framebuffer_height; // size of the window, set by the resize event
 
     GLuint m_hdr_fbo;
     GLuint m_hdr_color_buffer;
@@ -71,7 +112,7 @@ private:
     GLuint m_depth_map_tex;
 private:
     std::unique_ptr<Shader> make_shader(std::string const& vertex_path, std::string const& fragment_path, std::string geometry_path = "");
-    void window_size_listener(Event& event);
+    void window_size_listener(const Events::Window::FramebufferResized& event);
 
     void init_hdr_fbo();
     void resize_hdr_attachments();
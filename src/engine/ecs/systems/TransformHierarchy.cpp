@@ -0,0 +1,41 @@
+#include <cstddef>
+
+#include <engine/ecs/systems/TransformHierarchy.hpp>
+
+bool TransformHierarchy::compute_depths(std::vector<std::uint32_t>& parents, std::vector<std::uint32_t>& depths) {
+    constexpr std::uint32_t NO_DEPTH = UINT32_MAX;
+    constexpr std::uint32_t IN_CHAIN = UINT32_MAX - 1; // on the chain being walked
+
+    std::size_t count = parents.size();
+    depths.assign(count, NO_DEPTH);
+
+    std::vector<std::uint32_t> chain;
+    bool cycle_broken = false;
+
+    for(std::size_t i = 0; i < count; i++) {
+        // walk up to the first node of known depth, or to the root
+        chain.clear();
+
+        for(std::uint32_t index = i; depths[index] == NO_DEPTH; index = parents[index]) {
+            depths[index] = IN_CHAIN;
+            chain.push_back(index);
+
+            if(parents[index] == NO_PARENT)
+                break;
+
+            // the parent is further down the chain
+            if(depths[parents[index]] == IN_CHAIN) {
+                parents[index] = NO_PARENT;
+                cycle_broken = true;
+                break;
+            }
+        }
+
+        for(auto it = chain.rbegin(); it != chain.rend(); it++) {
+            std::uint32_t parent = parents[*it];
+            depths[*it] = parent == NO_PARENT ? 0 : depths[parent] + 1;
+        }
+    }
+
+    return cycle_broken;
+}
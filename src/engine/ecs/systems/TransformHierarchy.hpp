@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// TransformHierarchy
+// Ordering of the transform hierarchy for `TransformSystem`, without graphics dependencies.
+namespace TransformHierarchy {
+    constexpr std::uint32_t NO_PARENT = UINT32_MAX;
+
+    // depth of every node, given the index of every node's parent (NO_PARENT for roots).
+    // a parent chain which loops back onto itself has no root: the node closing the loop is made a
+    // root instead, by setting its parent to NO_PARENT. returns true if a cycle was broken
+    bool compute_depths(std::vector<std::uint32_t>& parents, std::vector<std::uint32_t>& depths);
+}
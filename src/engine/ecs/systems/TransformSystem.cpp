@@ -0,0 +1,224 @@
+#include <algorithm>
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <engine/ecs/systems/TransformSystem.hpp>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneView.hpp>
+
+#include <engine/ecs/components/Parent.hpp>
+#include <engine/ecs/components/Transform.hpp>
+#include <engine/ecs/components/WorldTransform.hpp>
+
+#include <engine/graphics/lib/GraphicsHelper.hpp>
+
+#include <lib/utilities/DebugAssert.hpp>
+
+TransformSystem::TransformSystem(Scene& scene): System{scene} {
+    reads<Components::Transform, Components::Parent>();
+    writes<Components::WorldTransform>();
+}
+
+void TransformSystem::update(float dt) {
+    change_tick_type since = m_last_tick;
+    m_last_tick = m_scene->advance_change_tick();
+
+    m_rebuilt = hierarchy_changed(since);
+
+    if(m_rebuilt)
+        build_hierarchy(); // marks all entities dirty
+
+    // local matrices of the changed transforms, read in view order
+    auto compute_local_matrix = [this](Entity entity, component_reference_t<const Components::Transform> transform, const Components::WorldTransform&) {
+        std::size_t index = m_indices.get(entity);
+
+        m_local_matrices[index] = GraphicsHelper::create_model_matrix(transform);
+        m_dirty[index] = true;
+    };
+
+    if(m_rebuilt)
+        SceneView<const Components::Transform, const Components::WorldTransform>(*m_scene).parallel_each(compute_local_matrix);
+    else
+        SceneView<const Components::Transform, const Components::WorldTransform>(*m_scene, SceneViewChanged<Components::Transform>{since}).parallel_each(compute_local_matrix);
+
+    // entities of the same depth only depend on entities of lower depths
+    ThreadPool& thread_pool = m_scene->get_thread_pool();
+    std::size_t begin = 0;
+
+    for(std::size_t end : m_depth_ends) {
+        if(end - begin < 2 * MIN_PARALLEL_RANGE) {
+            update_range(begin, end);
+        } else {
+            thread_pool.parallel_for(end - begin, MIN_PARALLEL_RANGE, [&](std::size_t range_begin, std::size_t range_end) {
+                update_range(begin + range_begin, begin + range_end);
+            });
+        }
+
+        begin = end;
+    }
+
+    write_world_transforms();
+
+    std::swap(m_moved, m_dirty);
+    std::fill(m_dirty.begin(), m_dirty.end(), false);
+}
+
+void TransformSystem::update_range(std::size_t begin, std::size_t end) {
+    for(std::size_t i = begin; i < end; i++) {
+        std::uint32_t parent = m_parents[i];
+
+        if(parent != NO_PARENT && m_dirty[parent])
+            m_dirty[i] = true;
+
+        if(!m_dirty[i])
+            continue;
+
+        m_world_matrices[i] = parent == NO_PARENT ? m_local_matrices[i] : m_world_matrices[parent] * m_local_matrices[i];
+        m_normal_matrices[i] = glm::inverseTranspose(glm::mat3(m_world_matrices[i]));
+    }
+}
+
+void TransformSystem::write_world_transform(std::size_t index, Components::WorldTransform& world_transform) const {
+    // the matrix of the last update becomes the previous matrix, also for the entities which moved
+    // in the last update but not in this one
+    world_transform.previous_matrix = world_transform.matrix;
+
+    if(m_dirty[index]) {
+        world_transform.matrix = m_world_matrices[index];
+        world_transform.normal_matrix = m_normal_matrices[index];
+
+        if(m_rebuilt)
+            world_transform.previous_matrix = world_transform.matrix;
+    }
+}
+
+void TransformSystem::write_world_transforms() {
+    std::size_t count = m_entities.size();
+    std::size_t written = 0;
+
+    for(std::size_t i = 0; i < count; i++)
+        written += m_dirty[i] | m_moved[i];
+
+    if(written == 0)
+        return;
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    // when many entities moved, walk the world transforms in the order they are stored
+    if(written * DENSE_WRITE_RATIO >= count) {
+        ComponentArray<Components::WorldTransform>* world_transforms = m_scene->get_component_array<Components::WorldTransform>();
+
+        m_scene->get_thread_pool().parallel_for(world_transforms->size(), MIN_PARALLEL_RANGE, [&](std::size_t begin, std::size_t end) {
+            for(std::size_t dense_index = begin; dense_index < end; dense_index++) {
+                Entity entity = world_transforms->begin()[dense_index];
+
+                // world transforms without a transform are not in the hierarchy
+                if(!m_indices.contains(entity))
+                    continue;
+
+                std::size_t index = m_indices.get(entity);
+
+                if(m_dirty[index] | m_moved[index]) {
+                    write_world_transform(index, world_transforms->get_data_at(dense_index));
+                    world_transforms->mark_changed_at(dense_index);
+                }
+            }
+        });
+
+        return;
+    }
+#endif
+
+    for(std::size_t i = 0; i < count; i++)
+        if(m_dirty[i] | m_moved[i])
+            write_world_transform(i, m_scene->get_mutable_component<Components::WorldTransform>(m_entities[i]));
+}
+
+bool TransformSystem::hierarchy_changed(change_tick_type since) const {
+    // removed components only show in the counts
+    if(m_scene->count_components<Components::Transform>() != m_transform_count
+        || m_scene->count_components<Components::WorldTransform>() != m_world_transform_count
+        || m_scene->count_components<Components::Parent>() != m_parent_count)
+        return true;
+
+    SceneView<const Components::Transform> added_transforms(*m_scene, SceneViewAdded<Components::Transform>{since});
+    SceneView<const Components::WorldTransform> added_world_transforms(*m_scene, SceneViewAdded<Components::WorldTransform>{since});
+    SceneView<const Components::Parent> changed_parents(*m_scene, SceneViewChanged<Components::Parent>{since});
+
+    return added_transforms.begin() != added_transforms.end()
+        || added_world_transforms.begin() != added_world_transforms.end()
+        || changed_parents.begin() != changed_parents.end();
+}
+
+void TransformSystem::build_hierarchy() {
+    for(Entity entity : m_entities)
+        m_indices.reset(entity);
+
+    // entities and parents in view order
+    std::vector<Entity> entities;
+
+    for(Entity entity : SceneView<const Components::Transform, const Components::WorldTransform>(*m_scene)) {
+        m_indices.set(entity, entities.size());
+        entities.push_back(entity);
+    }
+
+    std::size_t count = entities.size();
+    std::vector<std::uint32_t> parents(count, NO_PARENT);
+
+    for(std::size_t i = 0; i < count; i++) {
+        if(!m_scene->has_component<Components::Parent>(entities[i]))
+            continue;
+
+        Entity parent = m_scene->get_component<Components::Parent>(entities[i]).entity;
+
+        if(m_indices.contains(parent))
+            parents[i] = m_indices.get(parent);
+    }
+
+    // depth of every entity in the hierarchy
+    std::vector<std::uint32_t> depths;
+
+    if(TransformHierarchy::compute_depths(parents, depths) && !m_cycle_reported) {
+        ENGINE_LOG("Transform hierarchy contains a cycle, the entity closing it is treated as a root");
+        m_cycle_reported = true;
+    }
+
+    std::uint32_t max_depth = count > 0 ? *std::max_element(depths.begin(), depths.end()) : 0;
+
+    // counting sort by depth, stable so that siblings stay in view order
+    m_depth_ends.assign(count > 0 ? max_depth + 1 : 0, 0);
+
+    for(std::size_t i = 0; i < count; i++)
+        m_depth_ends[depths[i]]++;
+
+    std::size_t end = 0;
+    for(std::size_t& depth_end : m_depth_ends)
+        depth_end = end += depth_end;
+
+    std::vector<std::size_t> next(m_depth_ends.size());
+    for(std::size_t depth = 1; depth < m_depth_ends.size(); depth++)
+        next[depth] = m_depth_ends[depth - 1];
+
+    std::vector<std::uint32_t> order(count);
+    for(std::size_t i = 0; i < count; i++)
+        order[i] = next[depths[i]]++;
+
+    m_entities.resize(count);
+    m_parents.resize(count);
+
+    for(std::size_t i = 0; i < count; i++) {
+        m_entities[order[i]] = entities[i];
+        m_parents[order[i]] = parents[i] == NO_PARENT ? NO_PARENT : order[parents[i]];
+        m_indices.set(entities[i], order[i]);
+    }
+
+    m_local_matrices.assign(count, glm::mat4(1.0f));
+    m_world_matrices.assign(count, glm::mat4(1.0f));
+    m_normal_matrices.assign(count, glm::mat3(1.0f));
+    m_dirty.assign(count, true);
+    m_moved.assign(count, false);
+
+    m_transform_count = m_scene->count_components<Components::Transform>();
+    m_world_transform_count = m_scene->count_components<Components::WorldTransform>();
+    m_parent_count = m_scene->count_components<Components::Parent>();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <engine/ecs/core/ChangeTicks.hpp>
+#include <engine/ecs/core/PagedSparseArray.hpp>
+#include <engine/ecs/core/System.hpp>
+#include <engine/ecs/core/Types.hpp>
+#include <engine/ecs/systems/TransformHierarchy.hpp>
+
+#include <engine/ecs/components/WorldTransform.hpp>
+
+// TransformSystem
+// Computes the `WorldTransform` of every entity with a `Transform` and a `WorldTransform`.
+// An entity with a `Parent` is placed relative to its parent's world matrix.
+//
+// The entities are kept in a flat array in order of depth in the hierarchy, so that parents come
+// before their children. Each frame the local matrices of the changed transforms are computed in
+// view order and their entities marked dirty, then one pass over the array propagates dirty parents
+// to their children and recomputes the dirty matrices in flat arrays. The results are copied to the
+// `WorldTransform` components last, in the order they are stored when many entities moved.
+// The array is rebuilt only when the hierarchy changes.
+//
+// The matrix of the previous tick is kept in `WorldTransform::previous_matrix` for render interpolation.
+// It is the current matrix for the entities which did not move in the last tick, and for all entities
+// after the hierarchy is rebuilt, so that added entities do not move in from the origin.
+//
+// An entity whose parent has no `Transform` and `WorldTransform` (or was destroyed) is treated as a root.
+// So is one entity of every cycle of parents, which is logged once.
+class TransformSystem : public System {
+public:
+    TransformSystem(Scene& scene);
+
+    void update(float dt) override;
+
+private:
+    bool hierarchy_changed(change_tick_type since) const;
+    void build_hierarchy();
+
+    // recompute the dirty matrices of the entities in [begin, end), whose parents are all before `begin`
+    void update_range(std::size_t begin, std::size_t end);
+
+    // copy the matrices of the entities which moved in this or the last update to their components
+    void write_world_transforms();
+    void write_world_transform(std::size_t index, Components::WorldTransform& world_transform) const;
+
+private:
+    static constexpr std::uint32_t NO_PARENT = TransformHierarchy::NO_PARENT;
+    static constexpr std::size_t MIN_PARALLEL_RANGE = 1024;
+    // the components are walked in storage order once one in this many entities moved
+    static constexpr std::size_t DENSE_WRITE_RATIO = 8;
+
+    // entities in hierarchy order
+    std::vector<Entity> m_entities;
+    std::vector<std::uint32_t> m_parents; // index of the parent in `m_entities`
+    std::vector<glm::mat4> m_local_matrices;
+    std::vector<glm::mat4> m_world_matrices;
+    std::vector<glm::mat3> m_normal_matrices;
+    std::vector<unsigned char> m_dirty;
+    std::vector<unsigned char> m_moved; // recomputed by the last update
+    bool m_rebuilt = false; // the hierarchy was rebuilt by this update
+    std::vector<std::size_t> m_depth_ends; // end of the entities of each depth
+    bool m_cycle_reported = false;
+
+    PagedSparseArray m_indices; // entity to index in `m_entities`
+
+    // matrices are recomputed for the transforms changed since this tick
+    change_tick_type m_last_tick = 0;
+    // number of components at the last build
+    entity_count_size_type m_transform_count = 0;
+    entity_count_size_type m_world_transform_count = 0;
+    entity_count_size_type m_parent_count = 0;
+};
@@ -23,13 +23,13 @@ glm::mat4 CameraWrapper::get_view_matrix() const {
     
     // return view_matrix;
 
-    const auto& camera_transform = m_scene->get_component<Components::Transform>(m_camera);
+    const glm::vec3& position = m_scene->get_component<Components::Transform>(m_camera).get<&Components::Transform::position>();
     auto& camera = m_scene->get_component<Components::Camera>(m_camera);
     
-    return glm::lookAt(camera_transform.position, camera_transform.position + camera.cam_front, camera.cam_up);
+    return glm::lookAt(position, position + camera.cam_front, camera.cam_up);
 }
 
-const Components::Transform& CameraWrapper::get_transform_component() const {
+Components::Transform CameraWrapper::get_transform_component() const {
     return m_scene->get_component<Components::Transform>(m_camera);
 }
 
@@ -81,21 +81,21 @@ CameraWrapper& CameraWrapper::operator=(const CameraWrapper& camera_wrapper) {
 }
 
 void CameraWrapper::translate_camera(InputConfig::BasicMovement direction, float distance) {
-    auto& camera_transform = m_scene->get_component<Components::Transform>(m_camera);
+    glm::vec3& position = m_scene->get_component<Components::Transform>(m_camera).get<&Components::Transform::position>();
     auto& camera = m_scene->get_component<Components::Camera>(m_camera);
 
     if (direction == InputConfig::BasicMovement::Forward)
-        camera_transform.position += camera.cam_front * distance;
+        position += camera.cam_front * distance;
     else if (direction == InputConfig::BasicMovement::Backward)
-        camera_transform.position -= camera.cam_front * distance;
+        position -= camera.cam_front * distance;
     if (direction == InputConfig::BasicMovement::Right)
-        camera_transform.position += camera.cam_right * distance;
+        position += camera.cam_right * distance;
     else if (direction == InputConfig::BasicMovement::Left)
-        camera_transform.position -= camera.cam_right * distance;
+        position -= camera.cam_right * distance;
     if (direction == InputConfig::BasicMovement::Up)
-        camera_transform.position += camera.world_up * distance;
+        position += camera.world_up * distance;
     else if (direction == InputConfig::BasicMovement::Down)
-        camera_transform.position -= camera.world_up * distance;
+        position -= camera.world_up * distance;
 }
 
 void CameraWrapper::zoom_camera(double offset) {
@@ -24,7 +24,7 @@ public:
     void rotate_camera(double x_offset, double y_offset);
     void zoom_camera(double offset);
 
-    const Components::Transform& get_transform_component() const;
+    Components::Transform get_transform_component() const; // gathered from the split transform fields
     const Components::Camera& get_camera_component() const;
 
     const Components::Camera& get_camera() const { return m_scene->get_component<Components::Camera>(m_camera); }
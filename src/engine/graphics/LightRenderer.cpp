@@ -5,12 +5,12 @@ LightRenderer::LightRenderer() {
     m_light_cube_shader = std::make_unique<Shader>(std::string(FS_SHADERS_DIR) + "light_cube.vs", std::string(FS_SHADERS_DIR) + "light_cube.fs");
 }
 
-void LightRenderer::draw_light_cube(Components::Transform& transform, const CameraWrapper& camera_wrapper, glm::vec3 light_color) {
+void LightRenderer::draw_light_cube(const glm::mat4& model_matrix, const GraphicsHelper::MVP& mvp, glm::vec3 light_color) {
     m_light_cube_shader->activate();
 
     ShaderDataTypes::MeshMatrices mesh_matrices;
     mesh_matrices.model_matrix = glm::mat4(1.0f);
-    mesh_matrices.mvp_matrix = GraphicsHelper::get_mvp_matrix(transform, camera_wrapper);
+    mesh_matrices.mvp_matrix = mvp.projection * mvp.view * model_matrix;
     mesh_matrices.normal_matrix = glm::mat4(1.0f);
 
     m_light_cube_shader->set_uniform<glm::mat4>("u_mesh_matrices.mvp_matrix", mesh_matrices.mvp_matrix);
@@ -205,7 +205,14 @@ void ModelManager::draw_mesh(const std::unique_ptr<Shader>& shader, MeshDrawData
 }
 
 void ModelManager::draw_model(const std::unique_ptr<Shader>& model_shader, std::size_t model_id,
-    const Components::Transform& transform, const GraphicsHelper::MVP& mvp) {    
+    const Components::Transform& transform, const GraphicsHelper::MVP& mvp) {
+    glm::mat4 model_matrix = GraphicsHelper::create_model_matrix(transform);
+
+    draw_model(model_shader, model_id, model_matrix, glm::inverseTranspose(glm::mat3(model_matrix)), mvp);
+}
+
+void ModelManager::draw_model(const std::unique_ptr<Shader>& model_shader, std::size_t model_id,
+    const glm::mat4& model_matrix, const glm::mat3& normal_matrix, const GraphicsHelper::MVP& mvp) {
     // retrieve model data
     auto it = m_models.begin();
     assert((it = m_models.find(model_id)) != m_models.end() && "Model with given ID does not exist");
@@ -214,9 +221,9 @@ void ModelManager::draw_model(const std::unique_ptr<Shader>& model_shader, std::
     model_shader->activate();
 
     ShaderDataTypes::MeshMatrices mesh_matrices;
-    mesh_matrices.model_matrix = GraphicsHelper::create_model_matrix(transform);
+    mesh_matrices.model_matrix = model_matrix;
     mesh_matrices.mvp_matrix = mvp.projection * mvp.view * mesh_matrices.model_matrix;
-    mesh_matrices.normal_matrix = glm::inverseTranspose(glm::mat3(mesh_matrices.model_matrix));
+    mesh_matrices.normal_matrix = normal_matrix;
     
     model_shader->set_uniform<glm::mat4>("u_mesh_matrices.model_matrix", mesh_matrices.model_matrix);
     model_shader->set_uniform<glm::mat4>("u_mesh_matrices.mvp_matrix", mesh_matrices.mvp_matrix);
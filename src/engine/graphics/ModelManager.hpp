@@ -57,6 +57,10 @@ public:
 
     void draw_model(const std::unique_ptr<Shader>& model_shader, std::size_t model_id,
         const Components::Transform& transform, const GraphicsHelper::MVP& mvp);
+
+    // draw with precomputed model and normal matrices
+    void draw_model(const std::unique_ptr<Shader>& model_shader, std::size_t model_id,
+        const glm::mat4& model_matrix, const glm::mat3& normal_matrix, const GraphicsHelper::MVP& mvp);
 private:
     using byte_ptr = char*;
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <engine/ecs/core/ChangeTicks.hpp>
+#include <engine/ecs/core/PagedSparseArray.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// RenderState
+// Copy of the render relevant components of one frame, extracted from the scene by
+// `RenderSystem::extract_render_state` and drawn by `RenderSystem::render`. Drawing only reads
+// the render state, so the next frame can be simulated while this one is rendered.
+struct RenderState {
+    struct ModelInstance {
+        Entity entity;
+        std::size_t model_id;
+        glm::mat4 matrix;
+        glm::mat3 normal_matrix;
+        glm::mat4 previous_matrix; // at the previous simulation tick
+
+        // matrix between the previous and the current tick
+        glm::mat4 interpolated_matrix(float interpolation) const { return previous_matrix + (matrix - previous_matrix) * interpolation; }
+    };
+
+    struct PointLight {
+        glm::mat4 matrix; // world matrix
+        glm::vec3 position; // world position
+        glm::vec3 color;
+    };
+
+    struct DirectionalLight {
+        glm::mat4 matrix;
+        glm::vec3 position;
+        glm::vec3 direction;
+        glm::vec3 color;
+    };
+
+    // camera
+    glm::vec3 camera_position;
+    glm::mat4 view;
+    glm::mat4 projection;
+
+    unsigned int framebuffer_width = 0, framebuffer_height = 0;
+
+    // fraction of a tick simulated past the previous tick, models are drawn at that point between their previous
+    // and current matrices. the matrices are blended element wise, which is close to the rotation for the small
+    // rotations of one tick
+    float interpolation = 1.0f;
+
+    std::vector<ModelInstance> models; // in draw order (sorted by model id)
+    std::vector<PointLight> point_lights;
+    std::vector<DirectionalLight> dir_lights;
+    std::vector<unsigned int> cubemaps;
+
+    // models are copied in full only when models were added, removed or changed since the
+    // last extraction into this state. otherwise only the changed world matrices are copied
+    change_tick_type extracted_tick = 0;
+    entity_count_size_type extracted_model_count = 0; // number of `Model` components at the last extraction
+    entity_count_size_type extracted_renderable_count = 0;
+    PagedSparseArray model_indices; // entity to index in `models`
+};
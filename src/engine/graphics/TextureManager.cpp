@@ -179,7 +179,7 @@ unsigned int TextureManager::add_cubemap(CubemapFaces faces) {
     return texture_id;
 }
 
-void TextureManager::draw_cubemap(unsigned int cubemap_id, const std::unique_ptr<Shader>& cubemap_shader, const CameraWrapper& camera_wrapper) {
+void TextureManager::draw_cubemap(unsigned int cubemap_id, const std::unique_ptr<Shader>& cubemap_shader, const GraphicsHelper::MVP& mvp) {
     glDepthFunc(GL_LEQUAL); // change depth function so depth test passes when values are equal to depth buffer's content
 
     cubemap_shader->activate();
@@ -189,8 +189,8 @@ void TextureManager::draw_cubemap(unsigned int cubemap_id, const std::unique_ptr
     // we can have a ResourceManager to hold all the shader objects in memory and return pointers (and an id) to them
     cubemap_shader->set_uniform<int>("skybox", 0);
 
-    glm::mat4 view = glm::mat4(glm::mat3(camera_wrapper.get_view_matrix())); // remove translation from the view matrix
-    glm::mat4 projection = camera_wrapper.get_projection_matrix();
+    glm::mat4 view = glm::mat4(glm::mat3(mvp.view)); // remove translation from the view matrix
+    glm::mat4 projection = mvp.projection;
     glm::mat4 vp_matrix = projection * view;
 
     cubemap_shader->set_uniform<glm::mat4>("u_VP_matrix", vp_matrix);
@@ -6,7 +6,7 @@
 #include <string>
 #include <memory>
 
-#include <engine/graphics/CameraWrapper.hpp>
+#include <engine/graphics/lib/GraphicsHelper.hpp>
 #include <engine/graphics/Shader.hpp>
 #include <engine/graphics/MeshProcessor.hpp>
 
@@ -35,7 +35,7 @@ public:
 
     cubemaps_interface_type load_cubemaps(std::unordered_map<std::string, CubemapFaces> cubemaps);
     unsigned int add_cubemap(CubemapFaces faces);
-    void draw_cubemap(unsigned int cubemap_id, const std::unique_ptr<Shader>& cubemap_shader, const CameraWrapper& camera_wrapper);
+    void draw_cubemap(unsigned int cubemap_id, const std::unique_ptr<Shader>& cubemap_shader, const GraphicsHelper::MVP& mvp); // uses the view and projection
     
     bool gamma_correct_required(MeshTextureType tex_type) const;
 private:
@@ -39,6 +39,7 @@ void GUIMain::init_gui() {
 void GUIMain::init_windows() {
     m_camera_control_window = std::make_unique<CameraControlWindow>(*m_window_manager, *m_gui_state, ImVec2{0, 0});
     m_light_control_window = std::make_unique<LightControlWindow>(*m_window_manager, *m_gui_state, ImVec2{0, 0});
+    m_ecs_stats_window = std::make_unique<EcsStatsWindow>(*m_window_manager, *m_gui_state, ImVec2{0, 0});
 }
 
 void GUIMain::new_frame() {
@@ -50,6 +51,7 @@ void GUIMain::new_frame() {
 void GUIMain::update() {
     m_camera_control_window->update();
     m_light_control_window->update();
+    m_ecs_stats_window->update();
 }
 
 void GUIMain::render() {
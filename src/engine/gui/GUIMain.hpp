@@ -10,6 +10,7 @@
 
 #include <engine/gui/GUIState.hpp>
 #include <engine/gui/windows/CameraControlWindow.hpp>
+#include <engine/gui/windows/EcsStatsWindow.hpp>
 #include <engine/gui/windows/LightControlWindow.hpp>
 
 class GUIMain {
@@ -39,6 +40,7 @@ private:
     // list of gui windows
     std::unique_ptr<CameraControlWindow> m_camera_control_window;
     std::unique_ptr<LightControlWindow> m_light_control_window;
+    std::unique_ptr<EcsStatsWindow> m_ecs_stats_window;
 
     void init_gui();
     void init_windows();
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include <engine/ecs/core/SceneStats.hpp>
+
 class GUIState {
 public:
     // ---------- BLINN PHONG SETTINGS -----------
@@ -40,4 +42,9 @@ public:
     // hdr
     float exposure = 1.5;
     bool hdr_enabled = true;
+
+    // -------------------------------------------
+
+    // ECS statistics of the main scene, refreshed every frame
+    SceneStats scene_stats;
 };
\ No newline at end of file
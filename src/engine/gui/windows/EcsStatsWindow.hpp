@@ -0,0 +1,61 @@
+#pragma once
+
+#include <engine/gui/GUIWindow.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
+
+// entity and component memory of the main scene, from `GUIState::scene_stats`
+class EcsStatsWindow : public GUIWindow {
+public:
+    // constructor is from GUIWindow
+    using GUIWindow::GUIWindow; // Inherit GUIWindow's constructor
+
+    void update() {
+        const SceneStats& stats = m_gui_state->scene_stats;
+
+        ImGui::SetNextWindowPos(ImVec2(10, 570), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(m_window_length, m_window_height), ImGuiCond_Once);
+
+        ImGui::Begin("ECS Stats");
+
+        ImGui::Text("Entities: %u living, %u ids used, %u max", stats.entities.living, stats.entities.ids_used, stats.entities.max_entities);
+        ImGui::Text("Free list: %u", stats.entities.free_list);
+        ImGui::Text("Reserved: %.1f KB (entities %.1f KB)", to_kb(stats.total_bytes_reserved()), to_kb(stats.entities.bytes_reserved));
+
+        constexpr ImGuiTableFlags table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable;
+
+        if(ImGui::BeginTable("components", 8, table_flags)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Component");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Capacity");
+            ImGui::TableSetupColumn("Used KB");
+            ImGui::TableSetupColumn("Reserved KB");
+            ImGui::TableSetupColumn("Sparse KB");
+            ImGui::TableSetupColumn("+/-");
+            ImGui::TableSetupColumn("Swaps");
+            ImGui::TableHeadersRow();
+
+            for(const ComponentStats& component : stats.components) {
+                ImGui::TableNextRow();
+
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(component.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%u", component.count);
+                ImGui::TableNextColumn(); ImGui::Text("%zu", component.capacity);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", to_kb(component.bytes_used));
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", to_kb(component.bytes_reserved));
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", to_kb(component.sparse_bytes));
+                ImGui::TableNextColumn(); ImGui::Text("%zu/%zu", component.churn.adds, component.churn.removes);
+                ImGui::TableNextColumn(); ImGui::Text("%zu", component.churn.swap_removes);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+private:
+    static float to_kb(std::size_t bytes) { return bytes / 1024.0f; }
+
+    unsigned int m_window_length = 700;
+    unsigned int m_window_height = 300;
+};
\ No newline at end of file
@@ -35,17 +35,13 @@ void InputHandler::handle_mouse_callback(double xpos_in, double ypos_in) {
     m_mouse_data.mouse_last_x = xpos_in;
     m_mouse_data.mouse_last_y = ypos_in;
 
-    // send event
-    Event event(Events::Input::MOUSE);
-    event.set_param(Events::Input::Mouse::MOUSE_DATA, m_mouse_data);
-    m_scene->send_event(event);
+    // dispatched with the other queued events at the start of the frame's update
+    m_scene->queue_event(Events::Input::MouseMoved{.x_offset = xoffset, .y_offset = yoffset});
 }
 
 void InputHandler::handle_scroll_callback(double x_offset, double y_offset) {
     m_scroll_data.x_offset = x_offset;
     m_scroll_data.y_offset = y_offset;
 
-    Event event(Events::Input::SCROLL);
-    event.set_param(Events::Input::Scroll::SCROLL_DATA, m_scroll_data);
-    m_scene->send_event(event);
+    m_scene->queue_event(Events::Input::Scrolled{.x_offset = x_offset, .y_offset = y_offset});
 }
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include <engine/threading/ThreadPool.hpp>
+
+namespace {
+    // pool and queue of the worker running on this thread
+    thread_local const ThreadPool* t_pool = nullptr;
+    thread_local unsigned int t_queue = 0;
+
+    // failed attempts to find a task before `wait` blocks
+    constexpr unsigned int MAX_FAILED_STEALS = 64;
+}
+
+ThreadPool::ThreadPool(unsigned int worker_count) {
+    for(unsigned int i = 0; i < worker_count + 1; i++)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+
+    for(unsigned int i = 0; i < worker_count; i++)
+        m_workers.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{m_sleep_mutex};
+        m_stop = true;
+    }
+
+    m_wake.notify_all();
+
+    for(std::thread& worker : m_workers)
+        worker.join();
+}
+
+unsigned int ThreadPool::default_worker_count() {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+
+    // the thread calling into the pool does work too
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+void ThreadPool::submit(task_type task, std::atomic<std::size_t>& pending) {
+    WorkQueue& queue = *m_queues[current_queue()];
+
+    {
+        std::lock_guard lock{queue.mutex};
+        queue.tasks.push_back([this, task = std::move(task), &pending] {
+            task();
+
+            // `pending` may be destroyed by the waiting thread as soon as it reaches zero
+            if(pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                wake_all();
+        });
+    }
+
+    m_queued_tasks.fetch_add(1, std::memory_order_release);
+
+    {
+        // lock so that the notification can not be missed by a thread about to sleep
+        std::lock_guard lock{m_sleep_mutex};
+    }
+
+    m_wake.notify_one();
+}
+
+void ThreadPool::wait(const std::atomic<std::size_t>& pending) {
+    unsigned int queue = current_queue();
+    unsigned int failed_steals = 0;
+
+    while(pending.load(std::memory_order_acquire) > 0) {
+        if(run_one(queue)) {
+            failed_steals = 0;
+        } else if(++failed_steals < MAX_FAILED_STEALS) {
+            std::this_thread::yield();
+        } else {
+            // the remaining tasks are running on other threads. sleep until they are done or
+            // a new task is queued, which may be one of them waiting on its own tasks
+            std::unique_lock lock{m_sleep_mutex};
+            m_wake.wait(lock, [this, &pending] {
+                return pending.load(std::memory_order_acquire) == 0 || m_queued_tasks.load(std::memory_order_acquire) > 0;
+            });
+
+            failed_steals = 0;
+        }
+    }
+}
+
+bool ThreadPool::run_pending_task() {
+    return run_one(current_queue());
+}
+
+void ThreadPool::parallel_for(std::size_t count, std::size_t grain, const range_function_type& func) {
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t chunks = (count + grain - 1) / grain;
+
+    if(chunks <= 1 || m_workers.empty()) {
+        if(count > 0)
+            func(0, count);
+
+        return;
+    }
+
+    // queue all chunks but the first, which the calling thread runs directly
+    std::atomic<std::size_t> pending = chunks - 1;
+
+    for(std::size_t chunk = 1; chunk < chunks; chunk++) {
+        std::size_t begin = chunk * grain;
+        std::size_t end = std::min(begin + grain, count);
+
+        submit([&func, begin, end] { func(begin, end); }, pending);
+    }
+
+    func(0, std::min(grain, count));
+
+    wait(pending);
+}
+
+void ThreadPool::worker_loop(unsigned int index) {
+    t_pool = this;
+    t_queue = index;
+
+    while(true) {
+        if(run_one(index))
+            continue;
+
+        std::unique_lock lock{m_sleep_mutex};
+        m_wake.wait(lock, [this] { return m_stop || m_queued_tasks.load(std::memory_order_acquire) > 0; });
+
+        if(m_stop && m_queued_tasks.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
+
+bool ThreadPool::run_one(unsigned int index) {
+    task_type task;
+
+    // own queue first (newest task, still warm in cache)
+    {
+        WorkQueue& queue = *m_queues[index];
+        std::lock_guard lock{queue.mutex};
+
+        if(!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+
+    // steal the oldest task of another queue
+    for(std::size_t i = 1; !task && i < m_queues.size(); i++) {
+        WorkQueue& queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard lock{queue.mutex};
+
+        if(!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if(!task)
+        return false;
+
+    m_queued_tasks.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+
+    return true;
+}
+
+void ThreadPool::wake_all() {
+    {
+        std::lock_guard lock{m_sleep_mutex};
+    }
+
+    m_wake.notify_all();
+}
+
+unsigned int ThreadPool::current_worker() const {
+    return t_pool == this ? t_queue : count_workers();
+}
+
+unsigned int ThreadPool::current_queue() {
+    if(t_pool == this)
+        return t_queue;
+
+    // threads outside the pool spread their tasks over all queues
+    return m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool
+// Every worker has its own task queue: it pops tasks from the back of its queue and steals
+// from the front of the other queues when its own is empty. Threads that wait for tasks
+// (`wait`, `parallel_for`) run queued tasks instead of blocking, so the calling thread
+// takes part in the work and tasks may themselves wait on other tasks. Once there is
+// nothing left to run they sleep until their tasks are done.
+class ThreadPool {
+public:
+    using task_type = std::function<void()>;
+    using range_function_type = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // `worker_count` threads are started in addition to the threads calling into the pool
+    ThreadPool(unsigned int worker_count = default_worker_count());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static unsigned int default_worker_count();
+    unsigned int count_workers() const { return m_workers.size(); }
+
+    // index of the worker running on the calling thread, `count_workers()` for threads outside the pool
+    unsigned int current_worker() const;
+
+    // queue `task`, `pending` is decremented once it has run
+    void submit(task_type task, std::atomic<std::size_t>& pending);
+
+    // run queued tasks until `pending` reaches zero. sleeps while the last tasks run on other threads
+    void wait(const std::atomic<std::size_t>& pending);
+
+    // run one queued task on the calling thread. returns false if there was none
+    bool run_pending_task();
+
+    // call `func(begin, end)` on chunks of [0, count) of at most `grain` elements and return when all are done
+    void parallel_for(std::size_t count, std::size_t grain, const range_function_type& func);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<task_type> tasks;
+    };
+
+    void worker_loop(unsigned int index);
+
+    // pop a task from the queue of `index` or steal one from another queue, and run it
+    bool run_one(unsigned int index);
+    void wake_all();
+    unsigned int current_queue();
+
+private:
+    // one queue per worker, plus one so that tasks can be queued without any workers
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::atomic<std::size_t> m_queued_tasks = 0;
+    std::atomic<unsigned int> m_next_queue = 0; // round robin queue for tasks submitted from outside the pool
+
+    // idle workers and waiting threads sleep on `m_wake`
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};
@@ -94,11 +94,7 @@ void WindowManager::framebuffer_size_callback(GLFWwindow* window, int width, int
     if(!p_window_manager)
         ASSERT_MESSAGE("WindowManager handler not set");
 
-    Event event {Events::Window::RESIZED};
-    event.set_param(Events::Window::Resized::WIDTH, width);
-    event.set_param(Events::Window::Resized::HEIGHT, height);
-    
-    p_window_manager->m_scene->send_event(event);
+    p_window_manager->m_scene->queue_event(Events::Window::FramebufferResized{.width = width, .height = height});
 }
 
 void WindowManager::close_callback(GLFWwindow* window) {
@@ -16,4 +16,6 @@
 
 #else
 #define ASSERT(condition, message) do { } while (false)
+#define ASSERT_MESSAGE(message) do { } while (false)
+#define ENGINE_LOG(message) do { } while (false)
 #endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef> // for std::size_t
+#include <type_traits>
+
+// Static per-type ids, without RTTI or hash map lookups.
+// Every type gets a sequential id (0, 1, 2, ...) within its `Family` the first time
+// the id is requested. Ids are process wide and stay fixed for the lifetime of the program.
+template<typename Family>
+class FamilyTypeId {
+public:
+    template<typename T>
+    static std::size_t get() {
+        // initialization of function local statics is thread safe
+        static const std::size_t id = s_next_id++;
+        return id;
+    }
+
+    // number of ids handed out so far
+    static std::size_t count() { return s_next_id; }
+
+private:
+    inline static std::atomic<std::size_t> s_next_id{0};
+};
@@ -0,0 +1,114 @@
+#include <tests/EcsTests.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneCommandBuffer.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+struct Position {
+    float x = 0.0f;
+};
+
+constexpr int THREAD_COUNT = 8;
+
+// each thread records one entity, taking turns since threads outside the pool share a buffer
+void record_from_threads(Scene& scene, float first_x) {
+    std::atomic<int> turn = 0;
+    std::vector<std::thread> threads;
+
+    for(int i = 0; i < THREAD_COUNT; i++) {
+        threads.emplace_back([&scene, &turn, i, x = first_x + i] {
+            while(turn.load(std::memory_order_acquire) != i)
+                std::this_thread::yield();
+
+            SceneCommandBuffer& command_buffer = scene.get_command_buffer();
+            command_buffer.add_component(command_buffer.create_entity(), Position{x});
+
+            turn.store(i + 1, std::memory_order_release);
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+}
+
+}
+
+void register_command_buffer_tests(TestRunner& runner) {
+    runner.add("command_buffer/outside_threads_in_recording_order", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+        scene.set_worker_count(2);
+
+        record_from_threads(scene, 0.0f);
+        scene.flush_commands();
+
+        // a fresh scene hands out the entity ids in recording order
+        TEST_CHECK(context, scene.count_components<Position>() == THREAD_COUNT);
+
+        for(int i = 0; i < THREAD_COUNT; i++)
+            TEST_CHECK(context, scene.get_component<Position>(Entity(i)).x == float(i));
+    });
+
+    runner.add("command_buffer/records_from_workers", [](TestContext& context) {
+        constexpr std::size_t COUNT = 1000;
+
+        Scene scene {COUNT * 2};
+        scene.register_component<Position>();
+        scene.set_worker_count(3);
+
+        scene.get_thread_pool().parallel_for(COUNT, 10, [&scene](std::size_t begin, std::size_t end) {
+            SceneCommandBuffer& command_buffer = scene.get_command_buffer();
+
+            for(std::size_t i = begin; i < end; i++)
+                command_buffer.add_component(command_buffer.create_entity(), Position{float(i)});
+        });
+
+        scene.flush_commands();
+
+        std::vector<int> recorded(COUNT);
+        for(Entity entity = 0; entity < COUNT; entity++)
+            recorded[std::size_t(scene.get_component<Position>(entity).x)]++;
+
+        TEST_CHECK(context, scene.count_components<Position>() == COUNT);
+        TEST_CHECK(context, std::count(recorded.begin(), recorded.end(), 1) == COUNT);
+    });
+
+    runner.add("command_buffer/set_worker_count_keeps_commands", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+
+        SceneCommandBuffer& command_buffer = scene.get_command_buffer();
+        command_buffer.add_component(command_buffer.create_entity(), Position{1.0f});
+
+        // the thread pool is started, the buffer of this thread is kept
+        scene.get_thread_pool();
+        command_buffer.add_component(command_buffer.create_entity(), Position{2.0f});
+        TEST_CHECK(context, &scene.get_command_buffer() == &command_buffer);
+
+        scene.set_worker_count(1);
+        TEST_CHECK(context, scene.count_components<Position>() == 2);
+    });
+
+    runner.add("command_buffer/playback_in_recording_order", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+
+        SceneCommandBuffer& command_buffer = scene.get_command_buffer();
+        Entity entity = scene.create_entity();
+
+        command_buffer.add_component(entity, Position{1.0f});
+        command_buffer.remove_component<Position>(entity);
+        command_buffer.add_component(entity, Position{2.0f});
+        scene.flush_commands();
+
+        TEST_CHECK(context, scene.get_component<Position>(entity).x == 2.0f);
+        TEST_CHECK(context, command_buffer.empty());
+    });
+}
@@ -0,0 +1,58 @@
+#include <tests/EcsTests.hpp>
+
+#include <string>
+#include <utility>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+// counts move assignments of a component onto itself
+struct Name {
+    static inline int self_moves = 0;
+
+    std::string value;
+
+    Name() = default;
+    Name(std::string value) : value{std::move(value)} {}
+    Name(const Name&) = default;
+    Name(Name&&) = default;
+    Name& operator=(const Name&) = default;
+
+    Name& operator=(Name&& other) {
+        if(this == &other)
+            self_moves++;
+
+        value = std::move(other.value);
+        return *this;
+    }
+};
+
+}
+
+void register_component_tests(TestRunner& runner) {
+    runner.add("component/remove_last_without_self_move", [](TestContext& context) {
+        Scene scene {8};
+        scene.register_component<Name>();
+        Name::self_moves = 0;
+
+        Entity a = scene.create_entity();
+        Entity b = scene.create_entity();
+        Entity c = scene.create_entity();
+        scene.add_component(a, Name{"a"});
+        scene.add_component(b, Name{"b"});
+        scene.add_component(c, Name{"c"});
+
+        scene.remove_component<Name>(c); // the last component
+        scene.remove_component<Name>(a); // moves the last component into its place
+
+        TEST_CHECK(context, Name::self_moves == 0);
+        TEST_CHECK(context, scene.count_components<Name>() == 1);
+        TEST_CHECK(context, scene.get_component<Name>(b).value == "b");
+
+        scene.remove_component<Name>(b); // the only component
+        TEST_CHECK(context, Name::self_moves == 0);
+        TEST_CHECK(context, scene.count_components<Name>() == 0);
+    });
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <tests/TestRunner.hpp>
+
+// tests of the ECS library, one function per area
+void register_entity_tests(TestRunner& runner);
+void register_command_buffer_tests(TestRunner& runner);
+void register_component_tests(TestRunner& runner);
+void register_group_tests(TestRunner& runner);
+void register_query_tests(TestRunner& runner);
+void register_sort_tests(TestRunner& runner);
+void register_snapshot_tests(TestRunner& runner);
+void register_stats_tests(TestRunner& runner);
+void register_transform_hierarchy_tests(TestRunner& runner);
+void register_thread_pool_tests(TestRunner& runner);
+void register_event_queue_tests(TestRunner& runner);
+
+inline void register_ecs_tests(TestRunner& runner) {
+    register_entity_tests(runner);
+    register_command_buffer_tests(runner);
+    register_component_tests(runner);
+    register_group_tests(runner);
+    register_query_tests(runner);
+    register_sort_tests(runner);
+    register_snapshot_tests(runner);
+    register_stats_tests(runner);
+    register_transform_hierarchy_tests(runner);
+    register_thread_pool_tests(runner);
+    register_event_queue_tests(runner);
+}
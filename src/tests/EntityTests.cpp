@@ -0,0 +1,64 @@
+#include <tests/EcsTests.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+struct Position {
+    float x = 0.0f;
+};
+
+}
+
+void register_entity_tests(TestRunner& runner) {
+    runner.add("entity/capacity_grows", [](TestContext& context) {
+        Scene scene {4};
+        scene.register_component<Position>();
+
+        std::vector<Entity> entities;
+        for(int i = 0; i < 10; i++) {
+            entities.push_back(scene.create_entity());
+            scene.add_component(entities.back(), Position{float(i)});
+        }
+
+        TEST_CHECK(context, scene.get_max_entities() >= 10);
+
+        // every entity got its own id and keeps its component
+        std::vector<Entity> sorted = entities;
+        std::sort(sorted.begin(), sorted.end());
+        TEST_CHECK(context, std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+        for(int i = 0; i < 10; i++)
+            TEST_CHECK(context, scene.get_component<Position>(entities[i]).x == float(i));
+    });
+
+    runner.add("entity/capacity_grows_in_bulk", [](TestContext& context) {
+        Scene scene {8};
+        scene.register_component<Position>();
+
+        Prefab prefab {Position{1.0f}};
+
+        scene.destroy_entity(scene.create_entity()); // one id to reuse
+        std::vector<Entity> entities = scene.create_entities(100, prefab);
+
+        TEST_CHECK(context, entities.size() == 100);
+        TEST_CHECK(context, scene.get_max_entities() >= 100);
+        TEST_CHECK(context, scene.count_components<Position>() == 100);
+    });
+
+    runner.add("entity/reuse_destroyed", [](TestContext& context) {
+        Scene scene {2};
+
+        Entity a = scene.create_entity();
+        scene.create_entity();
+        scene.destroy_entity(a);
+
+        // the destroyed id is reused before the capacity grows
+        TEST_CHECK(context, scene.create_entity() == a);
+        TEST_CHECK(context, scene.get_max_entities() == 2);
+    });
+}
@@ -0,0 +1,130 @@
+#include <tests/EcsTests.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <engine/ecs/core/EventManager.hpp>
+#include <engine/ecs/core/EventQueue.hpp>
+
+namespace {
+
+struct Numbered {
+    int producer;
+    int sequence;
+};
+
+constexpr int PRODUCER_COUNT = 4;
+constexpr int EVENTS_PER_PRODUCER = 20000;
+
+// checks that every producer's events arrive once each and in order
+class Receiver {
+public:
+    Receiver() : m_next(PRODUCER_COUNT, 0) {}
+
+    void receive(const Numbered& event) {
+        if(event.sequence != m_next[event.producer])
+            m_in_order = false;
+
+        m_next[event.producer] = event.sequence + 1;
+        m_received++;
+    }
+
+    int received() const { return m_received; }
+
+    bool all_received_in_order() const {
+        for(int next : m_next)
+            if(next != EVENTS_PER_PRODUCER)
+                return false;
+
+        return m_in_order && m_received == PRODUCER_COUNT * EVENTS_PER_PRODUCER;
+    }
+
+private:
+    std::vector<int> m_next;
+    int m_received = 0;
+    bool m_in_order = true;
+};
+
+// run `produce(producer)` on PRODUCER_COUNT threads while `consume()` drains on the calling thread
+template<typename Produce, typename Consume>
+void race(Produce produce, Consume consume, const Receiver& receiver) {
+    std::atomic<bool> start = false;
+    std::vector<std::thread> producers;
+
+    for(int producer = 0; producer < PRODUCER_COUNT; producer++) {
+        producers.emplace_back([&start, &produce, producer] {
+            while(!start.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            produce(producer);
+        });
+    }
+
+    start.store(true, std::memory_order_release);
+
+    while(receiver.received() < PRODUCER_COUNT * EVENTS_PER_PRODUCER)
+        consume();
+
+    for(std::thread& producer : producers)
+        producer.join();
+
+    // nothing is left over
+    consume();
+}
+
+}
+
+void register_event_queue_tests(TestRunner& runner) {
+    runner.add("event_queue/producers_race_consumer", [](TestContext& context) {
+        EventQueue queue {64};
+        Receiver receiver;
+
+        auto produce = [&queue](int producer) {
+            for(int sequence = 0; sequence < EVENTS_PER_PRODUCER; sequence++) {
+                EventQueue::Record record;
+                record.type = 0;
+
+                Numbered event {producer, sequence};
+                std::memcpy(record.payload, &event, sizeof(event));
+
+                while(!queue.try_push(record))
+                    std::this_thread::yield();
+            }
+        };
+
+        auto consume = [&queue, &receiver] {
+            EventQueue::Record record;
+
+            while(queue.try_pop(record)) {
+                Numbered event;
+                std::memcpy(&event, record.payload, sizeof(event));
+                receiver.receive(event);
+            }
+        };
+
+        race(produce, consume, receiver);
+
+        TEST_CHECK(context, receiver.all_received_in_order());
+        TEST_CHECK(context, queue.size() == 0);
+    });
+
+    runner.add("event_queue/order_kept_through_overflow", [](TestContext& context) {
+        // small enough that the producers overflow it all the time
+        EventManager event_manager {8};
+        Receiver receiver;
+        event_manager.add_listener<&Receiver::receive>(&receiver);
+
+        auto produce = [&event_manager](int producer) {
+            for(int sequence = 0; sequence < EVENTS_PER_PRODUCER; sequence++)
+                event_manager.queue_event(Numbered{producer, sequence});
+        };
+
+        race(produce, [&event_manager] { event_manager.dispatch_queued_events(); }, receiver);
+
+        TEST_CHECK(context, receiver.all_received_in_order());
+        TEST_CHECK(context, event_manager.get_queue_stats().overflowed_events > 0);
+        TEST_CHECK(context, event_manager.get_queue_stats().queue_depth == 0);
+    });
+}
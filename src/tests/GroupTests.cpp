@@ -0,0 +1,198 @@
+#include <tests/EcsTests.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <engine/ecs/core/Group.hpp>
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneView.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+struct Velocity {
+    float x = 0.0f;
+};
+
+struct Mass {
+    float value = 0.0f;
+};
+
+struct Frozen {}; // tag
+
+constexpr int ENTITY_COUNT = 64;
+
+// entities with random subsets of the components
+std::vector<Entity> create_entities(Scene& scene, std::mt19937& random) {
+    std::vector<Entity> entities;
+
+    for(int i = 0; i < ENTITY_COUNT; i++) {
+        Entity entity = scene.create_entity();
+        entities.push_back(entity);
+
+        if(random() % 2)
+            scene.add_component(entity, Velocity{float(random() % 100)});
+        if(random() % 2)
+            scene.add_component(entity, Mass{float(i)});
+        if(random() % 3 == 0)
+            scene.add_component(entity, Frozen{});
+    }
+
+    return entities;
+}
+
+// the group has exactly the entities of the view of its types
+template<typename ...ComponentTypes>
+bool group_matches_view(Scene& scene) {
+    std::vector<Entity> in_group;
+    Group<ComponentTypes...>(scene).each([&](Entity entity, ComponentTypes&...) { in_group.push_back(entity); });
+
+    entity_count_size_type in_view = 0;
+
+    for(Entity entity : SceneView<ComponentTypes...>(scene)) {
+        in_view++;
+
+        if(std::find(in_group.begin(), in_group.end(), entity) == in_group.end())
+            return false;
+    }
+
+    return in_view == in_group.size() && Group<ComponentTypes...>(scene).size() == in_view;
+}
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+// the entities with Velocity and Mass are packed at the front of both arrays, in the same order
+bool group_is_packed(Scene& scene) {
+    OwningGroup& group = scene.get_owning_group<Velocity, Mass>();
+    ComponentArray<Velocity>* velocities = scene.get_component_array<Velocity>();
+    ComponentArray<Mass>* masses = scene.get_component_array<Mass>();
+
+    for(entity_count_size_type i = 0; i < group.size(); i++) {
+        Entity entity = velocities->begin()[i];
+
+        if(masses->begin()[i] != entity || !group.contains(entity))
+            return false;
+    }
+
+    for(Entity entity : *velocities)
+        if(masses->has_component(entity) != (velocities->get_index(entity) < group.size()))
+            return false;
+
+    return true;
+}
+#else
+bool group_is_packed(Scene& scene) { return group_matches_view<Velocity, Mass>(scene); }
+#endif
+
+void register_components(Scene& scene) {
+    scene.register_component<Velocity>();
+    scene.register_component<Mass>();
+    scene.register_component<Frozen>();
+}
+
+}
+
+void register_group_tests(TestRunner& runner) {
+    runner.add("group/packed_through_changes", [](TestContext& context) {
+        std::mt19937 random {1};
+        Scene scene {ENTITY_COUNT * 2};
+        register_components(scene);
+
+        std::vector<Entity> entities = create_entities(scene, random);
+
+        // declared after the entities exist
+        Group<Velocity, Mass> group {scene};
+        TEST_CHECK(context, group_is_packed(scene));
+        TEST_CHECK(context, (group_matches_view<Velocity, Mass>(scene)));
+
+        for(int round = 0; round < 200; round++) {
+            std::size_t index = random() % entities.size();
+            Entity entity = entities[index];
+
+            switch(random() % 4) {
+            case 0:
+                if(!scene.has_component<Velocity>(entity))
+                    scene.add_component(entity, Velocity{float(random() % 100)});
+                break;
+            case 1:
+                if(!scene.has_component<Mass>(entity))
+                    scene.add_component(entity, Mass{float(round)});
+                break;
+            case 2:
+                if(scene.has_component<Velocity>(entity))
+                    scene.remove_component<Velocity>(entity);
+                else if(scene.has_component<Mass>(entity))
+                    scene.remove_component<Mass>(entity);
+                break;
+            case 3:
+                scene.destroy_entity(entity);
+                entities[index] = scene.create_entity(); // may reuse the id
+                break;
+            }
+
+            TEST_CHECK(context, group_is_packed(scene));
+        }
+
+        TEST_CHECK(context, (group_matches_view<Velocity, Mass>(scene)));
+    });
+
+    runner.add("group/packed_after_sort", [](TestContext& context) {
+        std::mt19937 random {2};
+        Scene scene {ENTITY_COUNT * 2};
+        register_components(scene);
+        create_entities(scene, random);
+
+        Group<Velocity, Mass> group {scene};
+        scene.sort<Velocity>([](const Velocity& a, const Velocity& b) { return a.x < b.x; });
+
+        TEST_CHECK(context, group_is_packed(scene));
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+        // the group is iterated in order. archetypes are only sorted within each archetype
+        float last = -1.0f;
+        bool sorted = true;
+
+        group.each([&](Entity, Velocity& velocity, Mass&) {
+            sorted = sorted && last <= velocity.x;
+            last = velocity.x;
+        });
+
+        TEST_CHECK(context, sorted);
+#endif
+    });
+
+    runner.add("group/with_tag", [](TestContext& context) {
+        std::mt19937 random {3};
+        Scene scene {ENTITY_COUNT * 2};
+        register_components(scene);
+        std::vector<Entity> entities = create_entities(scene, random);
+
+        TEST_CHECK(context, (group_matches_view<Velocity, Frozen>(scene)));
+
+        for(Entity entity : entities) {
+            if(scene.has_component<Frozen>(entity))
+                scene.remove_component<Frozen>(entity);
+            else
+                scene.add_component(entity, Frozen{});
+        }
+
+        TEST_CHECK(context, (group_matches_view<Velocity, Frozen>(scene)));
+    });
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    runner.add("group/packed_after_snapshot_load", [](TestContext& context) {
+        std::mt19937 random {4};
+        Scene scene {ENTITY_COUNT * 2};
+        register_components(scene);
+        create_entities(scene, random);
+
+        Scene loaded {ENTITY_COUNT * 2};
+        register_components(loaded);
+        Group<Velocity, Mass> group {loaded};
+
+        TEST_CHECK(context, loaded.load_snapshot(scene.save_snapshot()));
+        TEST_CHECK(context, group_is_packed(loaded));
+        TEST_CHECK(context, (group_matches_view<Velocity, Mass>(loaded)));
+    });
+#endif
+}
@@ -0,0 +1,231 @@
+#include <tests/EcsTests.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <engine/ecs/core/Group.hpp>
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneView.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+struct Health {
+    int value = 0;
+};
+
+struct Armor {
+    int value = 0;
+};
+
+struct Dead {}; // tag
+
+constexpr int ENTITY_COUNT = 64;
+
+// entities visited by the view, sorted
+template<typename View>
+std::vector<Entity> visited(const View& view) {
+    std::vector<Entity> entities;
+
+    for(Entity entity : view)
+        entities.push_back(entity);
+    std::sort(entities.begin(), entities.end());
+
+    return entities;
+}
+
+// living entities whose signature matches, found by testing every entity
+std::vector<Entity> matching(Scene& scene, const std::vector<Entity>& living, Signature required, Signature excluded, bool exclusive) {
+    std::vector<Entity> entities;
+
+    for(Entity entity : living) {
+        Signature signature = scene.get_entity_signature(entity);
+
+        if(exclusive ? signature == required : (signature & required) == required && (signature & excluded).none())
+            entities.push_back(entity);
+    }
+
+    std::sort(entities.begin(), entities.end());
+    return entities;
+}
+
+}
+
+void register_query_tests(TestRunner& runner) {
+    runner.add("query/matches_through_changes", [](TestContext& context) {
+        std::mt19937 random {5};
+        Scene scene {ENTITY_COUNT * 2};
+        scene.register_component<Health>();
+        scene.register_component<Armor>();
+        scene.register_component<Dead>();
+
+        Signature health = scene.get_components_signature<Health>();
+        Signature health_armor = scene.get_components_signature<Health, Armor>();
+        Signature dead = scene.get_components_signature<Dead>();
+
+        std::vector<Entity> living;
+
+        auto check_views = [&] {
+            // constructed every time, so they get the cached queries
+            TEST_CHECK(context, visited(SceneView<Health>(scene)) == matching(scene, living, health, {}, false));
+            TEST_CHECK(context, visited(SceneView<Health, Armor>(scene)) == matching(scene, living, health_armor, {}, false));
+            TEST_CHECK(context, visited(SceneView<Health>(scene, SceneViewExclude<Dead>{})) == matching(scene, living, health, dead, false));
+            TEST_CHECK(context, visited(SceneView<Health>(scene, true)) == matching(scene, living, health, {}, true));
+        };
+
+        check_views(); // cached while empty
+
+        for(int round = 0; round < 300; round++) {
+            if(living.empty() || random() % 4 == 0) {
+                living.push_back(scene.create_entity());
+                continue;
+            }
+
+            std::size_t index = random() % living.size();
+            Entity entity = living[index];
+
+            switch(random() % 4) {
+            case 0:
+                if(scene.has_component<Health>(entity))
+                    scene.remove_component<Health>(entity);
+                else
+                    scene.add_component(entity, Health{round});
+                break;
+            case 1:
+                if(scene.has_component<Armor>(entity))
+                    scene.remove_component<Armor>(entity);
+                else
+                    scene.add_component(entity, Armor{round});
+                break;
+            case 2:
+                if(scene.has_component<Dead>(entity))
+                    scene.remove_component<Dead>(entity);
+                else
+                    scene.add_component(entity, Dead{});
+                break;
+            case 3:
+                scene.destroy_entity(entity);
+                living.erase(living.begin() + index);
+                break;
+            }
+
+            if(round % 10 == 0)
+                check_views();
+        }
+
+        check_views();
+    });
+
+    runner.add("query/created_after_entities", [](TestContext& context) {
+        Scene scene {ENTITY_COUNT * 2};
+        scene.register_component<Health>();
+        scene.register_component<Armor>();
+
+        Prefab prefab {Health{1}, Armor{2}};
+        std::vector<Entity> entities = scene.create_entities(10, prefab);
+        scene.remove_component<Armor>(entities[3]);
+
+        // a new query is filled from the living entities
+        TEST_CHECK(context, visited(SceneView<Health, Armor>(scene)).size() == 9);
+        TEST_CHECK(context, visited(SceneView<Health>(scene)).size() == 10);
+    });
+
+    runner.add("query/follows_batch_creation", [](TestContext& context) {
+        Scene scene {ENTITY_COUNT * 2};
+        scene.register_component<Health>();
+        scene.register_component<Armor>();
+
+        // cached before the entities exist
+        TEST_CHECK(context, visited(SceneView<Health, Armor>(scene)).empty());
+        TEST_CHECK(context, visited(SceneView<Health>(scene, true)).empty());
+
+        Prefab both {Health{1}, Armor{2}};
+        Prefab health_only {Health{1}};
+        std::vector<Entity> with_both = scene.create_entities(10, both);
+        std::vector<Entity> with_health = scene.create_entities(5, health_only);
+
+        TEST_CHECK(context, visited(SceneView<Health, Armor>(scene)) == with_both);
+        TEST_CHECK(context, visited(SceneView<Health>(scene, true)) == with_health);
+        TEST_CHECK(context, visited(SceneView<Health>(scene)).size() == 15);
+    });
+
+    runner.add("query/change_filters", [](TestContext& context) {
+        Scene scene {ENTITY_COUNT};
+        scene.register_component<Health>();
+        scene.register_component<Armor>();
+
+        Entity a = scene.create_entity();
+        Entity b = scene.create_entity();
+        scene.add_components(a, Health{1}, Armor{1});
+        scene.add_components(b, Health{2}, Armor{2});
+
+        change_tick_type since = scene.advance_change_tick();
+
+        TEST_CHECK(context, visited(SceneView<Health>(scene, SceneViewChanged<Health>{since})).empty());
+
+        scene.get_mutable_component<Health>(b).value = 3;
+        TEST_CHECK(context, visited(SceneView<Health>(scene, SceneViewChanged<Health>{since})) == std::vector<Entity>{b});
+        TEST_CHECK(context, visited(SceneView<Health>(scene, SceneViewAdded<Health>{since})).empty());
+
+        // writing through a view marks the components as changed, reading does not
+        since = scene.advance_change_tick();
+        SceneView<Health, const Armor>(scene).each([](Entity, Health&, const Armor&) {});
+
+        TEST_CHECK(context, visited(SceneView<Health>(scene, SceneViewChanged<Health>{since})).size() == 2);
+        TEST_CHECK(context, visited(SceneView<Armor>(scene, SceneViewChanged<Armor>{since})).empty());
+
+        since = scene.advance_change_tick();
+        Entity c = scene.create_entity();
+        scene.add_component(c, Health{4});
+
+        TEST_CHECK(context, visited(SceneView<Health>(scene, SceneViewAdded<Health>{since})) == std::vector<Entity>{c});
+    });
+
+    runner.add("query/writes_notify_observers", [](TestContext& context) {
+        constexpr int COUNT = 4096; // several parallel chunks
+        Scene scene {COUNT};
+        scene.register_component<Health>();
+        scene.register_component<Armor>();
+        scene.set_worker_count(2);
+
+        Prefab both {Health{1}, Armor{1}};
+        std::vector<Entity> entities = scene.create_entities(COUNT, both);
+        std::sort(entities.begin(), entities.end());
+
+        std::vector<Entity> changed_health;
+        std::vector<Entity> changed_armor;
+        scene.on_changed<Health>([&](const std::vector<Entity>& changed) { changed_health.insert(changed_health.end(), changed.begin(), changed.end()); });
+        scene.on_changed<Armor>([&](const std::vector<Entity>& changed) { changed_armor.insert(changed_armor.end(), changed.begin(), changed.end()); });
+        scene.flush_observers();
+
+        // each entity is delivered once per flush, however often it was written
+        auto delivered = [&](std::vector<Entity>& changed) {
+            scene.flush_observers();
+            std::vector<Entity> sorted = changed;
+            std::sort(sorted.begin(), sorted.end());
+            changed.clear();
+
+            return sorted;
+        };
+
+        changed_health.clear();
+        changed_armor.clear();
+
+        SceneView<Health, const Armor>(scene).each([](Entity, Health& health, const Armor&) { health.value++; });
+        SceneView<Health, const Armor>(scene).each([](Entity, Health& health, const Armor&) { health.value++; });
+        TEST_CHECK(context, delivered(changed_health) == entities);
+        TEST_CHECK(context, delivered(changed_armor).empty());
+
+        SceneView<Armor>(scene).parallel_each([](Entity, Armor& armor) { armor.value++; });
+        TEST_CHECK(context, delivered(changed_armor) == entities);
+        TEST_CHECK(context, delivered(changed_health).empty());
+
+        Group<Health, Armor>(scene).each([](Entity, Health& health, Armor&) { health.value++; });
+        TEST_CHECK(context, delivered(changed_health) == entities);
+        TEST_CHECK(context, delivered(changed_armor) == entities);
+
+        SceneView<const Health>(scene).each([](Entity, const Health&) {});
+        TEST_CHECK(context, delivered(changed_health).empty());
+    });
+}
@@ -0,0 +1,198 @@
+#include <tests/EcsTests.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// snapshots are only supported by the sparse set storage
+#if !defined(ECS_ARCHETYPE_STORAGE)
+namespace {
+
+struct Position {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct Name {
+    std::string value;
+};
+
+struct Player {}; // tag
+
+// counts the copies of itself
+struct CopyCounter {
+    static inline int copies = 0;
+
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter&) { copies++; }
+    CopyCounter(CopyCounter&&) = default;
+    CopyCounter& operator=(const CopyCounter&) { copies++; return *this; }
+    CopyCounter& operator=(CopyCounter&&) = default;
+};
+
+// split, with fields which are not trivially copyable
+struct Label {
+    std::string text;
+    CopyCounter counter;
+};
+
+void create_entities(Scene& scene) {
+    for(int i = 0; i < 10; i++) {
+        Entity entity = scene.create_entity();
+        scene.add_component(entity, Position{float(i), float(-i)});
+
+        if(i % 3 == 0)
+            scene.add_component(entity, Player{});
+    }
+
+    scene.destroy_entity(4);
+    scene.destroy_entity(7);
+}
+
+// loads `bytes` into a scene with entities, and checks that the scene is unchanged if loading fails
+bool load_or_keep(TestContext& context, const std::vector<std::byte>& bytes, std::size_t size) {
+    Scene scene {16};
+    scene.register_component<Position>();
+    scene.register_component<Player>();
+    scene.add_component(scene.create_entity(), Position{1.0f, 2.0f});
+
+    SceneSnapshot before = scene.save_snapshot();
+
+    // copied into aligned memory, without the bytes past `size`
+    std::vector<std::byte> copy(bytes.begin(), bytes.begin() + size);
+    bool loaded = scene.load_snapshot(copy.data(), copy.size());
+
+    if(!loaded)
+        TEST_CHECK(context, scene.save_snapshot() == before);
+
+    return loaded;
+}
+
+std::vector<std::byte> saved_bytes() {
+    Scene scene {16};
+    scene.register_component<Position>();
+    scene.register_component<Player>();
+    create_entities(scene);
+
+    SceneSnapshot snapshot = scene.save_snapshot();
+    return {snapshot.data(), snapshot.data() + snapshot.size()};
+}
+
+// offset of the SnapshotEntitiesHeader, after the header and the two component types
+const std::size_t ENTITIES_OFFSET = sizeof(SnapshotHeader) + 2 * sizeof(SnapshotComponentType);
+
+}
+
+template<>
+struct component_fields<Label> {
+    using type = ComponentFields<&Label::text, &Label::counter>;
+};
+
+static_assert(!is_snapshot_component_v<Label>, "Split components with non trivially copyable fields can not be saved");
+
+void register_snapshot_tests(TestRunner& runner) {
+    runner.add("snapshot/round_trip", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+        scene.register_component<Player>();
+        create_entities(scene);
+
+        SceneSnapshot snapshot = scene.save_snapshot();
+        TEST_CHECK(context, !snapshot.empty());
+
+        Scene loaded {16};
+        loaded.register_component<Position>();
+        loaded.register_component<Player>();
+
+        TEST_CHECK(context, loaded.load_snapshot(snapshot));
+        TEST_CHECK(context, loaded.save_snapshot() == snapshot);
+        TEST_CHECK(context, loaded.get_stats().entities.living == 8);
+        TEST_CHECK(context, loaded.get_component<Position>(9).y == -9.0f);
+        TEST_CHECK(context, loaded.has_component<Player>(9) && !loaded.has_component<Player>(8));
+    });
+
+    runner.add("snapshot/rejects_non_trivial_components", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+        scene.register_component<Player>();
+        create_entities(scene);
+
+        SceneSnapshot snapshot = scene.save_snapshot();
+
+        Scene with_name {16};
+        with_name.register_component<Position>();
+        with_name.register_component<Name>();
+        with_name.add_component(with_name.create_entity(), Name{"name"});
+
+        TEST_CHECK(context, with_name.save_snapshot().empty());
+
+        // a snapshot can not be loaded either, and the scene is kept
+        TEST_CHECK(context, !with_name.load_snapshot(snapshot));
+        TEST_CHECK(context, with_name.get_component<Name>(0).value == "name");
+    });
+
+    runner.add("snapshot/rejects_non_trivial_split_components", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+        scene.register_component<Label>();
+
+        Entity entity = scene.create_entity();
+        SceneSnapshot snapshot = scene.save_snapshot();
+        TEST_CHECK(context, snapshot.empty());
+
+        // the fields are moved into their streams, not copied
+        CopyCounter::copies = 0;
+        scene.add_component(entity, Label{"label", {}});
+        scene.emplace_component<Label>(scene.create_entity(), std::string{"emplaced"});
+
+        TEST_CHECK(context, CopyCounter::copies == 0);
+        TEST_CHECK(context, scene.get_component<Label>(entity).get<&Label::text>() == "label");
+        TEST_CHECK(context, scene.save_snapshot().empty());
+    });
+
+    runner.add("snapshot/rejects_truncated", [](TestContext& context) {
+        std::vector<std::byte> bytes = saved_bytes();
+
+        for(std::size_t size = 0; size < bytes.size(); size++)
+            TEST_CHECK(context, !load_or_keep(context, bytes, size));
+
+        TEST_CHECK(context, load_or_keep(context, bytes, bytes.size()));
+    });
+
+    runner.add("snapshot/rejects_corrupt_counts", [](TestContext& context) {
+        std::vector<std::byte> bytes = saved_bytes();
+
+        auto corrupt = [&](std::size_t offset, entity_count_size_type value) {
+            std::vector<std::byte> corrupted = bytes;
+            std::memcpy(corrupted.data() + offset, &value, sizeof(value));
+
+            return load_or_keep(context, corrupted, corrupted.size());
+        };
+
+        TEST_CHECK(context, !corrupt(ENTITIES_OFFSET + offsetof(SnapshotEntitiesHeader, living_count), NO_INDEX_MARKER - 1));
+        TEST_CHECK(context, !corrupt(ENTITIES_OFFSET + offsetof(SnapshotEntitiesHeader, destroyed_count), 1000));
+        TEST_CHECK(context, !corrupt(ENTITIES_OFFSET + offsetof(SnapshotEntitiesHeader, last_entity), 1));
+        TEST_CHECK(context, !corrupt(sizeof(SnapshotHeader) + offsetof(SnapshotComponentType, count), 3)); // Position count
+        TEST_CHECK(context, !corrupt(sizeof(SnapshotHeader) + sizeof(SnapshotComponentType) + offsetof(SnapshotComponentType, count), 1)); // Player count
+    });
+
+    runner.add("snapshot/survives_corrupt_bytes", [](TestContext& context) {
+        std::vector<std::byte> bytes = saved_bytes();
+
+        // some corruptions still make a valid snapshot (such as in component values), the others must
+        // be rejected without changing the scene, and without reading out of bounds
+        for(std::size_t i = 0; i < bytes.size(); i++) {
+            std::vector<std::byte> corrupted = bytes;
+            corrupted[i] ^= std::byte{0xA5};
+
+            load_or_keep(context, corrupted, corrupted.size());
+        }
+    });
+}
+#else
+void register_snapshot_tests(TestRunner& runner) {}
+#endif
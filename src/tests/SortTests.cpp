@@ -0,0 +1,133 @@
+#include <tests/EcsTests.hpp>
+
+#include <vector>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneView.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+namespace {
+
+struct Depth {
+    float z = 0.0f;
+};
+
+struct Order {
+    int value = 0;
+};
+
+constexpr float DEPTHS[] = {3.0f, 1.0f, 4.0f, 1.5f, 5.0f, 9.0f, 2.0f, 6.0f};
+
+void create_entities(Scene& scene) {
+    for(float depth : DEPTHS) {
+        Entity entity = scene.create_entity();
+        scene.add_component(entity, Depth{depth});
+        scene.add_component(entity, Order{int(-depth * 10.0f)});
+    }
+}
+
+template<typename ...ComponentTypes>
+std::vector<float> visited_depths(Scene& scene) {
+    std::vector<float> depths;
+
+    for(Entity entity : SceneView<ComponentTypes...>(scene))
+        depths.push_back(scene.get_component<Depth>(entity).z);
+
+    return depths;
+}
+
+bool is_ascending(const std::vector<float>& depths) {
+    for(std::size_t i = 1; i < depths.size(); i++)
+        if(depths[i - 1] > depths[i])
+            return false;
+
+    return true;
+}
+
+bool by_depth(const Depth& a, const Depth& b) { return a.z < b.z; }
+
+}
+
+void register_sort_tests(TestRunner& runner) {
+    runner.add("sort/existing_view_follows_sort", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Depth>();
+        scene.register_component<Order>();
+        create_entities(scene);
+
+        // the queries exist before sorting
+        visited_depths<Depth>(scene);
+        visited_depths<Depth, Order>(scene);
+
+        scene.sort<Depth>(by_depth);
+
+        TEST_CHECK(context, visited_depths<Depth>(scene).size() == std::size(DEPTHS));
+        TEST_CHECK(context, is_ascending(visited_depths<Depth>(scene)));
+        TEST_CHECK(context, is_ascending(visited_depths<Depth, Order>(scene)));
+    });
+
+    runner.add("sort/new_view_follows_sort", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Depth>();
+        scene.register_component<Order>();
+        create_entities(scene);
+
+        scene.sort<Depth>(by_depth);
+
+        TEST_CHECK(context, is_ascending(visited_depths<Depth, Order>(scene)));
+    });
+
+    runner.add("sort/view_follows_sort_like", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Depth>();
+        scene.register_component<Order>();
+        create_entities(scene);
+
+        visited_depths<Order>(scene);
+
+        scene.sort<Depth>(by_depth);
+        scene.sort_like<Order, Depth>();
+
+        TEST_CHECK(context, is_ascending(visited_depths<Order>(scene)));
+    });
+
+#if !defined(ECS_ARCHETYPE_STORAGE)
+    runner.add("sort/new_view_follows_array_after_changes", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Depth>();
+        scene.register_component<Order>();
+        create_entities(scene);
+
+        scene.sort<Depth>(by_depth);
+
+        // the destroyed id is reused by an entity which is stored last
+        scene.destroy_entity(Entity(1));
+        Entity reused = scene.create_entity();
+        scene.add_component(reused, Depth{100.0f});
+        scene.add_component(reused, Order{});
+
+        std::vector<Entity> visited;
+        for(Entity entity : SceneView<Depth, Order>(scene))
+            visited.push_back(entity);
+
+        ComponentArray<Depth>* depths = scene.get_component_array<Depth>();
+        TEST_CHECK(context, visited == std::vector<Entity>(depths->begin(), depths->end()));
+    });
+#endif
+
+    runner.add("sort/resort_changes_view_order", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Depth>();
+        scene.register_component<Order>();
+        create_entities(scene);
+
+        scene.sort<Depth>(by_depth);
+        visited_depths<Depth, Order>(scene);
+
+        // Order is sorted last, by descending depth
+        scene.sort<Order>([](const Order& a, const Order& b) { return a.value < b.value; });
+
+        std::vector<float> depths = visited_depths<Depth, Order>(scene);
+        TEST_CHECK(context, is_ascending({depths.rbegin(), depths.rend()}));
+    });
+}
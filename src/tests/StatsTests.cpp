@@ -0,0 +1,50 @@
+#include <tests/EcsTests.hpp>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/SceneStats.hpp>
+#include <engine/ecs/core/Types.hpp>
+
+// churn is only counted by the sparse set storage
+#if !defined(ECS_ARCHETYPE_STORAGE)
+namespace {
+
+struct Position {
+    float x = 0.0f;
+};
+
+ComponentChurn position_churn(const Scene& scene) {
+    return scene.get_stats().components.at(0).churn;
+}
+
+}
+
+void register_stats_tests(TestRunner& runner) {
+    runner.add("stats/churn_spans_updates", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Position>();
+
+        Entity a = scene.create_entity();
+        Entity b = scene.create_entity();
+        scene.add_component(a, Position{});
+        scene.update(0.0f);
+
+        scene.add_component(b, Position{});
+        scene.remove_component<Position>(a); // moves b's component
+        scene.update(0.0f);
+
+        // several ticks of one frame
+        ComponentChurn churn = position_churn(scene);
+        TEST_CHECK(context, churn.adds == 2);
+        TEST_CHECK(context, churn.removes == 1);
+        TEST_CHECK(context, churn.swap_removes == 1);
+
+        scene.reset_churn();
+        scene.update(0.0f);
+
+        churn = position_churn(scene);
+        TEST_CHECK(context, churn.adds == 0 && churn.removes == 0 && churn.swap_removes == 0);
+    });
+}
+#else
+void register_stats_tests(TestRunner& runner) {}
+#endif
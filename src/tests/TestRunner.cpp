@@ -0,0 +1,39 @@
+#include <tests/TestRunner.hpp>
+
+#include <iostream>
+#include <utility>
+
+bool TestContext::check(bool passed, const char* expression, const char* file, int line) {
+    if(!passed) {
+        m_failures++;
+        std::cout << "    " << file << ":" << line << ": check failed: " << expression << "\n";
+    }
+
+    return passed;
+}
+
+void TestRunner::add(std::string name, test_function_type test) {
+    m_tests.push_back({std::move(name), std::move(test)});
+}
+
+std::size_t TestRunner::run(const std::string& filter) const {
+    std::size_t failed = 0, ran = 0;
+
+    for(const Test& test : m_tests) {
+        if(test.name.find(filter) == std::string::npos)
+            continue;
+
+        TestContext context;
+        test.function(context);
+        ran++;
+
+        if(context.count_failures() > 0)
+            failed++;
+
+        std::cout << (context.count_failures() > 0 ? "FAIL " : "ok   ") << test.name << "\n";
+    }
+
+    std::cout << ran - failed << "/" << ran << " tests passed\n";
+
+    return failed;
+}
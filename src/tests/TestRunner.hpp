@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// TestRunner
+// Runs registered tests and reports the failed checks. A test is a function which checks its
+// results with TEST_CHECK, which records a failure and continues, so one run lists every failure:
+//      runner.add("view/sort", [](TestContext& context) {
+//          Scene scene; ...
+//          TEST_CHECK(context, entities == expected);
+//      });
+// Checks do not rely on `assert`, so the tests also run (and fail) in release builds.
+
+class TestContext {
+public:
+    // record a failure if `passed` is false
+    bool check(bool passed, const char* expression, const char* file, int line);
+
+    std::size_t count_failures() const { return m_failures; }
+
+private:
+    std::size_t m_failures = 0;
+};
+
+#define TEST_CHECK(context, expression) (context).check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+class TestRunner {
+public:
+    using test_function_type = std::function<void(TestContext& context)>;
+
+    void add(std::string name, test_function_type test);
+
+    // run the tests whose name contains `filter`. returns the number of failed tests
+    std::size_t run(const std::string& filter) const;
+
+private:
+    struct Test {
+        std::string name;
+        test_function_type function;
+    };
+
+    std::vector<Test> m_tests;
+};
@@ -0,0 +1,164 @@
+#include <tests/EcsTests.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <engine/ecs/core/Scene.hpp>
+#include <engine/ecs/core/System.hpp>
+#include <engine/threading/ThreadPool.hpp>
+
+namespace {
+
+struct Counter {
+    int value = 0;
+};
+
+// appends its id to a shared log, and checks that no conflicting system runs at the same time
+class LoggingSystem : public System {
+public:
+    LoggingSystem(Scene& scene, int id, std::vector<int>& log, std::mutex& log_mutex, std::atomic<int>& running)
+        : System(scene), m_id{id}, m_log{&log}, m_log_mutex{&log_mutex}, m_running{&running} {
+        writes<Counter>();
+    }
+
+    void update(float dt) override {
+        if(m_running->fetch_add(1) != 0)
+            m_overlapped = true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        {
+            std::lock_guard lock{*m_log_mutex};
+            m_log->push_back(m_id);
+        }
+
+        m_running->fetch_sub(1);
+    }
+
+    bool overlapped() const { return m_overlapped; }
+
+private:
+    int m_id;
+    std::vector<int>* m_log;
+    std::mutex* m_log_mutex;
+    std::atomic<int>* m_running;
+    bool m_overlapped = false;
+};
+
+template<int ID>
+class OrderedSystem : public LoggingSystem {
+public:
+    using LoggingSystem::LoggingSystem;
+};
+
+}
+
+void register_thread_pool_tests(TestRunner& runner) {
+    runner.add("thread_pool/runs_every_task_once", [](TestContext& context) {
+        ThreadPool thread_pool {3};
+
+        constexpr std::size_t TASK_COUNT = 1000;
+        std::vector<std::atomic<int>> runs(TASK_COUNT);
+        std::atomic<std::size_t> pending = TASK_COUNT;
+
+        for(std::size_t i = 0; i < TASK_COUNT; i++)
+            thread_pool.submit([&runs, i] { runs[i].fetch_add(1); }, pending);
+
+        thread_pool.wait(pending);
+
+        bool once = true;
+        for(std::atomic<int>& count : runs)
+            once = once && count.load() == 1;
+
+        TEST_CHECK(context, once);
+    });
+
+    runner.add("thread_pool/parallel_for_covers_range", [](TestContext& context) {
+        ThreadPool thread_pool {3};
+
+        for(std::size_t count : {0, 1, 7, 64, 1000, 1001}) {
+            std::vector<std::atomic<int>> runs(count);
+
+            thread_pool.parallel_for(count, 16, [&runs](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; i++)
+                    runs[i].fetch_add(1);
+            });
+
+            bool once = true;
+            for(std::atomic<int>& run : runs)
+                once = once && run.load() == 1;
+
+            TEST_CHECK(context, once);
+        }
+    });
+
+    runner.add("thread_pool/nested_waits", [](TestContext& context) {
+        // more waiting tasks than workers, so workers wait inside tasks while others are queued
+        ThreadPool thread_pool {2};
+
+        std::atomic<std::size_t> total = 0;
+
+        thread_pool.parallel_for(16, 1, [&](std::size_t, std::size_t) {
+            thread_pool.parallel_for(16, 1, [&](std::size_t, std::size_t) {
+                std::atomic<std::size_t> pending = 4;
+
+                for(int i = 0; i < 4; i++)
+                    thread_pool.submit([&total] { total.fetch_add(1); }, pending);
+
+                thread_pool.wait(pending);
+            });
+        });
+
+        TEST_CHECK(context, total.load() == 16 * 16 * 4);
+    });
+
+    // std::clock measures wall time on Windows
+#if !defined(_WIN32)
+    runner.add("thread_pool/wait_sleeps", [](TestContext& context) {
+        ThreadPool thread_pool {1};
+        std::atomic<std::size_t> pending = 1;
+        std::atomic<bool> started = false;
+
+        thread_pool.submit([&started] {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        }, pending);
+
+        // let the worker take the task, so that the calling thread has nothing to run
+        while(!started)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        std::clock_t start = std::clock();
+        thread_pool.wait(pending);
+
+        // a spinning wait keeps the calling thread busy for the whole 300ms
+        double cpu_seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+        TEST_CHECK(context, cpu_seconds < 0.15);
+    });
+#endif
+
+    runner.add("thread_pool/systems_keep_conflict_order", [](TestContext& context) {
+        Scene scene {16};
+        scene.register_component<Counter>();
+        scene.set_worker_count(3);
+
+        std::vector<int> log;
+        std::mutex log_mutex;
+        std::atomic<int> running = 0;
+
+        // all write Counter, so they run one at a time in registration order
+        LoggingSystem& a = scene.register_system<OrderedSystem<0>>(0, log, log_mutex, running);
+        LoggingSystem& b = scene.register_system<OrderedSystem<1>>(1, log, log_mutex, running);
+        LoggingSystem& c = scene.register_system<OrderedSystem<2>>(2, log, log_mutex, running);
+
+        scene.update(0.0f);
+        scene.update(0.0f);
+
+        TEST_CHECK(context, (log == std::vector<int>{0, 1, 2, 0, 1, 2}));
+        TEST_CHECK(context, !a.overlapped() && !b.overlapped() && !c.overlapped());
+    });
+}
@@ -0,0 +1,35 @@
+#include <tests/EcsTests.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <engine/ecs/systems/TransformHierarchy.hpp>
+
+namespace {
+
+using TransformHierarchy::NO_PARENT;
+
+}
+
+void register_transform_hierarchy_tests(TestRunner& runner) {
+    runner.add("transform_hierarchy/depths", [](TestContext& context) {
+        // 3 -> 1 -> 0, 2 -> 0, 4
+        std::vector<std::uint32_t> parents = {NO_PARENT, 0, 0, 1, NO_PARENT};
+        std::vector<std::uint32_t> depths;
+
+        TEST_CHECK(context, !TransformHierarchy::compute_depths(parents, depths));
+        TEST_CHECK(context, depths == std::vector<std::uint32_t>({0, 1, 1, 2, 0}));
+    });
+
+    runner.add("transform_hierarchy/breaks_cycles", [](TestContext& context) {
+        // 0 -> 1 -> 2 -> 0, 3 -> 2, 4 -> 4
+        std::vector<std::uint32_t> parents = {1, 2, 0, 2, 4};
+        std::vector<std::uint32_t> depths;
+
+        TEST_CHECK(context, TransformHierarchy::compute_depths(parents, depths));
+
+        // the walk from 0 closes the cycle at 2, the entity parented to itself is a root
+        TEST_CHECK(context, parents == std::vector<std::uint32_t>({1, 2, NO_PARENT, 2, NO_PARENT}));
+        TEST_CHECK(context, depths == std::vector<std::uint32_t>({2, 1, 0, 1, 0}));
+    });
+}
@@ -0,0 +1,41 @@
+/*
+3dengine_tests [--filter snapshot/]
+
+cmake -S . -B build -DENGINE_BUILD_APPLICATION=OFF
+cmake --build build --target 3dengine_tests && ctest --test-dir build
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <tests/EcsTests.hpp>
+#include <tests/TestRunner.hpp>
+
+int main(int argc, char** argv) {
+    std::string filter;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if(arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+#if defined(ECS_ARCHETYPE_STORAGE)
+    std::cout << "storage: archetype\n";
+#elif defined(ECS_CHUNKED_COMPONENT_STORAGE)
+    std::cout << "storage: sparse set (chunked)\n";
+#else
+    std::cout << "storage: sparse set\n";
+#endif
+
+    TestRunner runner;
+    register_ecs_tests(runner);
+
+    return runner.run(filter) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}